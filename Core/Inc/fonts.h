@@ -19,6 +19,15 @@ typedef struct {
 	uint8_t   yAdvance;    ///< Newline distance (y axis)
 } GFXfont;
 
+/// Anti-aliased font: same glyph metrics as GFXfont, 4-bit coverage per pixel
+typedef struct {
+	uint8_t  *bitmap;      ///< Coverage nibbles (high nibble first), each glyph starts on a byte
+	GFXglyph *glyph;       ///< Glyph array
+	uint8_t   first;       ///< ASCII extents (first char)
+    uint8_t   last;        ///< ASCII extents (last char)
+	uint8_t   yAdvance;    ///< Newline distance (y axis)
+} GFXfontAA;
+
 extern GFXfont *gfxFont;
 extern const GFXfont mono9x7;
 extern const GFXfont mono9x7bold;
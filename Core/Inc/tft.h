@@ -116,6 +116,29 @@ extern "C" {
 #define FLIP_VERT       (1<<13)
 #define FLIP_HORIZ      (1<<14)
 
+/* Tipos --------------------------------------------------------------------*/
+/**
+ * @brief Alvo de desenho alternativo ao LCD (canvas em RAM, lista de comandos, etc.)
+ * @details Quando instalado com tft_setTarget(), tft_fillRect(), tft_drawPixel() e
+ * tft_drawRGBBitmap() deixam de acessar o barramento e repassam o retângulo, já
+ * recortado pelos limites da tela, para estas funções.
+ * fillCircle e fillTriangle são opcionais (NULL): quando presentes recebem a
+ * primitiva inteira, sem recorte, em vez das linhas que a compõem.
+ */
+typedef struct {
+	void (*fillRect)(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+	void (*writeRect)(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels);
+	void (*fillCircle)(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+	void (*fillTriangle)(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+} tft_target_t;
+
+/**
+ * @brief Retângulo em coordenadas de tela
+ */
+typedef struct {
+	int16_t x, y, w, h;
+} tft_rect_t;
+
 /* Protótipos de funções ---------------------------------------------------*/
 uint16_t tft_color565(uint8_t r, uint8_t g, uint8_t b);
 uint16_t tft_readPixel(int16_t x, int16_t y);
@@ -176,6 +199,10 @@ void tft_setTextSize (uint8_t size);
 void tft_setCursor(int16_t x, int16_t y);
 void tft_scrollup (uint16_t speed);
 void tft_scrolldown (uint16_t speed);
+#if defined(TFT_GLYPH_CACHE_BYTES)
+void tft_glyphCacheStats(uint32_t *hits, uint32_t *misses);
+void tft_glyphCacheFlush(void);
+#endif
 
 /* Funções de interação com a câmera e SD Card ------------------------------*/
 /* Testadas com LCD TFT ILI9340 */
@@ -190,6 +217,35 @@ void tft_gpio_init(void);
 /* Função mostrar uma imagem BMP de com 16 bits de cores --------------------*/
 void tft_drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h);
 
+/* Bitmaps indexados e de 1 bit ---------------------------------------------*/
+void tft_drawIndexedBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint8_t bpp,
+		const uint16_t *palette, int16_t key);
+void tft_drawBitmap1(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t fg, int32_t bg);
+
+/* Fontes suavizadas (4 bits por pixel) ------------------------------------*/
+void tft_setFontAA(const GFXfontAA *f);
+void tft_drawCharAA(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg);
+size_t tft_writeAA(uint8_t c);
+void tft_printstrAA(uint8_t *str);
+
+/* Alvo de desenho e escrita em bloco ---------------------------------------*/
+void tft_setTarget(const tft_target_t *t);
+const tft_target_t *tft_getTarget(void);
+int16_t tft_width(void);
+int16_t tft_height(void);
+void tft_startWrite(int16_t x, int16_t y, int16_t w, int16_t h);
+void tft_writeColors(const uint16_t *block, uint32_t n);
+void tft_writeColor(uint16_t color, uint32_t n);
+void tft_writeIndexed8(const uint8_t *index, const uint16_t *palette, uint32_t n);
+void tft_writeIndexed4(const uint8_t *index, uint8_t odd, const uint16_t *palette, uint32_t n);
+void tft_endWrite(void);
+void tft_setCapture(uint16_t *buf, int16_t w, int16_t h);
+
+/* Sincronismo com a varredura do painel ------------------------------------*/
+uint16_t tft_getScanline(void);
+void tft_waitVBlank(void);
+void tft_setTearingSync(uint8_t enable);
+
 #ifdef __cplusplus
 }
 #endif
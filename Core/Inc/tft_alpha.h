@@ -0,0 +1,54 @@
+/**
+ ******************************************************************************
+ * @file    tft_alpha.h
+ * @brief   Imagens RGB565 com canal alfa (A4 ou A8) para ícones suavizados.
+ * 			A mistura é feita contra uma cor de fundo conhecida ou contra o
+ * 			conteúdo atual da tela, lido da GRAM linha a linha.
+ ******************************************************************************
+ * @attention
+ *
+ * O alfa fica em um vetor separado dos pixels: A8 com um byte por pixel,
+ * A4 com dois pixels por byte (nibble alto à esquerda), cada linha
+ * começando em um byte novo.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_ALPHA_H
+#define __TFT_ALPHA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define TFT_ALPHA_A4		4
+#define TFT_ALPHA_A8		8
+#define TFT_ALPHA_READBACK	(-1)	//bg: mistura com o conteúdo da tela
+
+/* Funções inline -----------------------------------------------------------*/
+/**
+ * @brief Mistura duas cores RGB565, alpha de 0 (bg) a 255 (fg)
+ * @details Os três canais são misturados com uma única multiplicação: a cor é
+ * espalhada em 32 bits (0x07E0F81F) para que cada canal tenha folga acima dele.
+ */
+static inline uint16_t tft_blend565(uint16_t fg, uint16_t bg, uint8_t alpha)
+{
+	uint32_t a = (alpha + 4) >> 3;
+	uint32_t f = (fg | ((uint32_t)fg << 16)) & 0x07E0F81F;
+	uint32_t b = (bg | ((uint32_t)bg << 16)) & 0x07E0F81F;
+	uint32_t r = (b + (((f - b) * a) >> 5)) & 0x07E0F81F;
+	return (uint16_t)(r | (r >> 16));
+}
+
+/* Protótipos de funções ---------------------------------------------------*/
+void tft_drawAlphaBitmap(int16_t x, int16_t y, const uint16_t *pixels, const uint8_t *alpha, uint8_t abits,
+		int16_t w, int16_t h, int32_t bg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_ALPHA_H */
@@ -0,0 +1,59 @@
+/**
+ ******************************************************************************
+ * @file    tft_anim.h
+ * @brief   Animações em flash codificadas por diferença entre quadros.
+ * 			O primeiro quadro é completo; os seguintes guardam apenas os
+ * 			retângulos que mudaram, comprimidos em RLE. Os arquivos são
+ * 			gerados pela ferramenta Tools/anim_encode.c.
+ ******************************************************************************
+ * @attention
+ *
+ * Formato (palavras de 16 bits):
+ *  - cabeçalho: TFT_ANIM_MAGIC, w, h, quadros, ms por quadro, flags;
+ *  - cada quadro: número de retângulos e, para cada um, x, y, w, h
+ *    (relativos à animação) seguidos dos pixels em RLE;
+ *  - RLE: palavra de controle c; com o bit 15 ligado, repete a cor
+ *    seguinte (c & 0x7FFF) + 1 vezes; senão vêm c + 1 cores literais.
+ * Com TFT_ANIM_LOOP o último quadro volta ao primeiro e a reprodução
+ * continua a partir do segundo.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_ANIM_H
+#define __TFT_ANIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define TFT_ANIM_MAGIC		0x4E41	//"AN"
+#define TFT_ANIM_HEADER		6		//palavras do cabeçalho
+#define TFT_ANIM_LOOP		0x0001	//flag: último quadro retorna ao primeiro
+
+#define TFT_ANIM_RUN		0x8000	//bit de repetição da palavra de controle RLE
+
+/* Tipos --------------------------------------------------------------------*/
+typedef struct {
+	const uint16_t *data;		///< Animação em flash
+	const uint16_t *pos;		///< Próximo quadro a desenhar
+	const uint16_t *loop_pos;	///< Segundo quadro, onde o laço recomeça
+	int16_t x, y;				///< Posição na tela
+	uint16_t frame;				///< Índice do próximo quadro
+	uint32_t next_tick;			///< HAL_GetTick() do próximo quadro
+} tft_anim_t;
+
+/* Protótipos de funções ---------------------------------------------------*/
+int8_t tft_anim_init(tft_anim_t *a, const uint16_t *data, int16_t x, int16_t y);
+uint8_t tft_anim_step(tft_anim_t *a);
+uint8_t tft_anim_service(tft_anim_t *a);
+uint8_t tft_anim_done(const tft_anim_t *a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_ANIM_H */
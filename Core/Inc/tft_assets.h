@@ -0,0 +1,75 @@
+/**
+ ******************************************************************************
+ * @file    tft_assets.h
+ * @brief   Pacote de recursos (imagens e fontes) em flash, com índice ordenado.
+ * 			O pacote é gerado no PC por Tools/asset_pack.c e fica no setor
+ * 			ASSETS da flash (STM32F446RETX_FLASH.ld), podendo ser gravado sem
+ * 			regravar o firmware. Os dados são usados direto da flash.
+ ******************************************************************************
+ * @attention
+ *
+ * Formato (little-endian): cabeçalho tft_assetpack_t seguido de count
+ * entradas tft_asset_t ordenadas por id e dos dados, alinhados em 4 bytes.
+ * O id é o hash FNV-1a de 32 bits do nome (tft_asset_hash()).
+ * Fontes (TFT_ASSET_FONT): first, last, yAdvance, 1 byte livre, os
+ * GFXglyph (8 bytes cada, como na struct) e os bitmaps; tft_asset_font()
+ * monta um GFXfont apontando para a flash.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_ASSETS_H
+#define __TFT_ASSETS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define TFT_ASSETS_MAGIC	0x4B415054	//"TPAK"
+#define TFT_ASSETS_VERSION	1
+#define TFT_ASSET_NAME		12			//nome com o terminador
+
+#define TFT_ASSET_RGB565	1		//pixels RGB565 crus
+#define TFT_ASSET_RLE		2		//tft_drawRLE()
+#define TFT_ASSET_QOI		3		//tft_drawQOI()
+#define TFT_ASSET_JPEG		4		//tft_drawJPEG()
+#define TFT_ASSET_FONT		5		//fonte GFX
+
+/* Tipos --------------------------------------------------------------------*/
+typedef struct {
+	uint32_t id;					///< Hash do nome, chave da busca
+	uint32_t offset;				///< Início dos dados, a partir do início do pacote
+	uint32_t size;					///< Tamanho dos dados em bytes
+	uint16_t format;				///< TFT_ASSET_xxx
+	uint16_t w, h;					///< Dimensões das imagens (0 nas fontes)
+	uint16_t flags;
+	char name[TFT_ASSET_NAME];
+} tft_asset_t;
+
+typedef struct {
+	uint32_t magic;					///< TFT_ASSETS_MAGIC
+	uint16_t version;				///< TFT_ASSETS_VERSION
+	uint16_t count;					///< Quantidade de entradas
+	uint32_t size;					///< Tamanho total do pacote em bytes
+	uint32_t reserved;
+	tft_asset_t index[];			///< Entradas ordenadas por id
+} tft_assetpack_t;
+
+/* Protótipos de funções ---------------------------------------------------*/
+int8_t tft_assets_mount(const void *pack);
+uint16_t tft_assets_count(void);
+uint32_t tft_asset_hash(const char *name);
+const tft_asset_t *tft_asset_find(uint32_t id);
+const tft_asset_t *tft_asset_findName(const char *name);
+const void *tft_asset_data(const tft_asset_t *a);
+int8_t tft_asset_draw(int16_t x, int16_t y, const tft_asset_t *a);
+int8_t tft_asset_font(const tft_asset_t *a, GFXfont *font);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_ASSETS_H */
@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ * @file    tft_compose.h
+ * @brief   Composição de camadas em RAM (fundos em flash + sobreposições).
+ * 			As camadas são misturadas faixa a faixa em RAM e cada pixel é
+ * 			enviado ao LCD uma única vez, com suporte a transparência.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_COMPOSE_H
+#define __TFT_COMPOSE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#ifndef TFT_COMPOSE_LAYERS
+#define TFT_COMPOSE_LAYERS	4		//máximo de camadas
+#endif
+
+#define TFT_LAYER_SOLID		0		//retângulo de cor única
+#define TFT_LAYER_RGB565	1		//imagem RGB565 (flash ou RAM)
+#define TFT_LAYER_INDEXED	2		//imagem indexada de 8 bits com paleta e índice transparente
+#define TFT_LAYER_RGB565A8	3		//imagem RGB565 com canal alfa de 8 bits por pixel
+
+/* Tipos --------------------------------------------------------------------*/
+typedef struct {
+	uint8_t type;				///< TFT_LAYER_*
+	uint8_t alpha;				///< Opacidade da camada inteira (255 = opaca)
+	uint8_t visible;
+	int16_t x, y, w, h;			///< Posição e tamanho na tela
+	uint16_t color;				///< Cor da camada sólida
+	const void *pixels;			///< uint16_t RGB565 ou uint8_t índices
+	const uint8_t *mask;		///< Alfa por pixel (TFT_LAYER_RGB565A8)
+	const uint16_t *palette;	///< Paleta (TFT_LAYER_INDEXED)
+	int16_t key;				///< Índice transparente, -1 para nenhum
+} tft_layer_t;
+
+/* Protótipos de funções ---------------------------------------------------*/
+void tft_compose_clear(void);
+tft_layer_t *tft_compose_addSolid(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, uint8_t alpha);
+tft_layer_t *tft_compose_addImage(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels, uint8_t alpha);
+tft_layer_t *tft_compose_addIndexed(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels,
+		const uint16_t *palette, int16_t key, uint8_t alpha);
+tft_layer_t *tft_compose_addAlpha(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels, const uint8_t *mask);
+void tft_compose_move(tft_layer_t *l, int16_t x, int16_t y);
+void tft_compose_show(tft_layer_t *l, uint8_t visible);
+void tft_compose_touch(tft_layer_t *l);
+void tft_compose_draw(int16_t x, int16_t y, int16_t w, int16_t h);
+void tft_compose_update(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_COMPOSE_H */
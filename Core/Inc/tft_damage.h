@@ -0,0 +1,42 @@
+/**
+ ******************************************************************************
+ * @file    tft_damage.h
+ * @brief   Controle das regiões alteradas da tela (dirty rectangles).
+ * 			As regiões informadas são unidas enquanto isso reduz o custo de
+ * 			redesenho; no fim do quadro a aplicação recebe a lista mínima de
+ * 			retângulos a repintar.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_DAMAGE_H
+#define __TFT_DAMAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#ifndef TFT_DAMAGE_MAX
+#define TFT_DAMAGE_MAX			16	//máximo de retângulos guardados
+#endif
+#ifndef TFT_DAMAGE_WINDOW_COST
+#define TFT_DAMAGE_WINDOW_COST	16	//custo de abrir uma janela, em pixels
+#endif
+
+/* Protótipos de funções ---------------------------------------------------*/
+void tft_damage_reset(void);
+void tft_damage_add(int16_t x, int16_t y, int16_t w, int16_t h);
+uint8_t tft_damage_count(void);
+uint8_t tft_damage_get(tft_rect_t *rects, uint8_t max);
+void tft_damage_flush(void (*repaint)(int16_t x, int16_t y, int16_t w, int16_t h));
+void tft_damage_begin(const tft_target_t *inner);
+void tft_damage_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_DAMAGE_H */
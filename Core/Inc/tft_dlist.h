@@ -0,0 +1,35 @@
+/**
+ ******************************************************************************
+ * @file    tft_dlist.h
+ * @brief   Lista de comandos de desenho por quadro (display list).
+ * 			Entre tft_beginFrame() e tft_endFrame() as primitivas são gravadas
+ * 			em vez de executadas; no fim do quadro a lista é otimizada
+ * 			(remoção de comandos encobertos e união de retângulos) e executada.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_DLIST_H
+#define __TFT_DLIST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#ifndef TFT_DLIST_MAX
+#define TFT_DLIST_MAX	128		//comandos por lote, 16 bytes cada
+#endif
+
+/* Protótipos de funções ---------------------------------------------------*/
+void tft_beginFrame(void);
+void tft_endFrame(void);
+void tft_frameStats(uint16_t *recorded, uint16_t *executed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_DLIST_H */
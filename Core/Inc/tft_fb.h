@@ -0,0 +1,54 @@
+/**
+ ******************************************************************************
+ * @file    tft_fb.h
+ * @brief   Canvas em RAM (framebuffer indexado) para o driver tft.
+ * 			Enquanto o canvas está ativo todas as primitivas tft_* e o texto
+ * 			desenham na RAM; tft_fbX_flush() envia ao LCD apenas o que mudou.
+ ******************************************************************************
+ * @attention
+ *
+ * Com o canvas ativo as cores passadas às primitivas continuam RGB565 e são
+ * gravadas como o índice da paleta mais próximo. Para usar um índice
+ * exato, passe a cor da própria entrada da paleta (ou escreva direto em
+ * tft_fbX_buffer() e chame tft_fbX_markDirty()).
+ * Habilitado em user_setting.h com TFT_USE_FB8 e/ou TFT_USE_FB4.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_FB_H
+#define __TFT_FB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Canvas indexado de 8 bits ------------------------------------------------*/
+#if defined(TFT_USE_FB8)
+void tft_fb8_begin(void);
+void tft_fb8_end(void);
+uint8_t *tft_fb8_buffer(void);
+void tft_fb8_setPalette(const uint16_t *colors, uint16_t first, uint16_t n);
+void tft_fb8_markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+void tft_fb8_flush(void);
+#endif
+
+/* Canvas indexado de 4 bits ------------------------------------------------*/
+#if defined(TFT_USE_FB4)
+#define TFT_FB4_TILE	16		//lado do bloco usado no controle de alterações
+
+void tft_fb4_begin(void);
+void tft_fb4_end(void);
+uint8_t *tft_fb4_buffer(void);
+void tft_fb4_setPalette(const uint16_t *colors, uint8_t first, uint8_t n);
+void tft_fb4_markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+void tft_fb4_flush(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_FB_H */
@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ * @file    tft_image.h
+ * @brief   Imagens comprimidas em flash, decodificadas direto para o LCD.
+ * 			Os arquivos são gerados pela ferramenta Tools/img_encode.c.
+ ******************************************************************************
+ * @attention
+ *
+ * RLE (palavras de 16 bits): TFT_IMAGE_RLE, w, h e os pixels linha a
+ * linha no mesmo RLE das animações de tft_anim: palavra de controle c;
+ * com o bit 15 ligado repete a cor seguinte (c & 0x7FFF) + 1 vezes, senão
+ * vêm c + 1 cores literais. As repetições podem atravessar linhas.
+ *
+ * QOI (bytes): 'Q', '6', w e h (16 bits little-endian) e as operações do
+ * formato QOI adaptadas a RGB565 (campos de 5/6/5 bits, sem alfa):
+ * índice em uma tabela de 64 cores recentes, diferença pequena (DIFF),
+ * diferença guiada pelo verde (LUMA), repetição de até 62 pixels e cor
+ * literal (0xFE seguido da cor em little-endian). Indicado para imagens
+ * com gradientes ou fotos, onde o RLE comprime pouco.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_IMAGE_H
+#define __TFT_IMAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define TFT_IMAGE_RLE		0x4C52	//"RL"
+#define TFT_IMAGE_RUN		0x8000	//bit de repetição da palavra de controle RLE
+
+#define TFT_SCALE_NEAREST	0		//vizinho mais próximo
+#define TFT_SCALE_BILINEAR	1		//interpolação bilinear
+
+#define TFT_QOI_OP_INDEX	0x00	//00iiiiii: cor do índice i
+#define TFT_QOI_OP_DIFF		0x40	//01rrggbb: diferenças de -2 a 1
+#define TFT_QOI_OP_LUMA		0x80	//10gggggg rrrrbbbb: dg de -32 a 31, dr-dg e db-dg de -8 a 7
+#define TFT_QOI_OP_RUN		0xC0	//11nnnnnn: repete a cor anterior n+1 vezes
+#define TFT_QOI_OP_RGB		0xFE	//cor RGB565 literal
+#define TFT_QOI_MASK		0xC0
+#define TFT_QOI_HASH(r, g, b)	(((r) * 3 + (g) * 5 + (b) * 7) & 63)
+
+/* Protótipos de funções ---------------------------------------------------*/
+int8_t tft_drawRLE(int16_t x, int16_t y, const uint16_t *data);
+int8_t tft_drawQOI(int16_t x, int16_t y, const uint8_t *data);
+void tft_drawRGBBitmapScaled(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w, int16_t h, int16_t dw,
+		int16_t dh, uint8_t mode);
+void tft_testQOI(int16_t x, int16_t y, const uint8_t *qoi, const uint16_t *raw, uint8_t n, uint32_t *qoi_ms,
+		uint32_t *raw_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_IMAGE_H */
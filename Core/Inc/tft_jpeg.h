@@ -0,0 +1,49 @@
+/**
+ ******************************************************************************
+ * @file    tft_jpeg.h
+ * @brief   Decodificador JPEG baseline que desenha direto no LCD.
+ * 			A imagem é decodificada MCU a MCU e cada MCU é enviado em sua
+ * 			própria janela, sem buffer de tela.
+ ******************************************************************************
+ * @attention
+ *
+ * Suporta JPEG baseline (SOF0/SOF1) de 8 bits, em tons de cinza ou YCbCr
+ * com subamostragem 4:4:4, 4:2:2 ou 4:2:0, e intervalos de reinício
+ * (DRI). JPEG progressivo e aritmético retornam TFT_JPEG_ERR_UNSUPPORTED.
+ * A redução (1/2, 1/4, 1/8) é feita no próprio decodificador: em 1/2 e 1/4
+ * cada bloco passa por uma IDCT reduzida de 4x4 ou 2x2 e em 1/8 só o
+ * coeficiente DC é usado, sem IDCT.
+ * As tabelas ocupam cerca de 4 KB de RAM estática.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_JPEG_H
+#define __TFT_JPEG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define TFT_JPEG_OK					0
+#define TFT_JPEG_ERR_FORMAT			(-1)	//não é JPEG ou cabeçalho corrompido
+#define TFT_JPEG_ERR_UNSUPPORTED	(-2)	//progressivo, aritmético, 12 bits, subamostragem
+#define TFT_JPEG_ERR_DATA			(-3)	//erro nos dados comprimidos
+
+#define TFT_JPEG_SCALE_1			0
+#define TFT_JPEG_SCALE_1_2			1
+#define TFT_JPEG_SCALE_1_4			2
+#define TFT_JPEG_SCALE_1_8			3
+
+/* Protótipos de funções ---------------------------------------------------*/
+int8_t tft_jpegSize(const uint8_t *data, uint32_t size, uint16_t *w, uint16_t *h);
+int8_t tft_drawJPEG(int16_t x, int16_t y, const uint8_t *data, uint32_t size, uint8_t scale);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_JPEG_H */
@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ * @file    tft_pipe.h
+ * @brief   Desenho em faixas com dois buffers (ping-pong).
+ * 			Enquanto uma faixa é transmitida ao LCD a aplicação preenche a
+ * 			outra. A altura das faixas é calculada a partir da RAM disponível.
+ ******************************************************************************
+ * @attention
+ *
+ * A transmissão é síncrona por padrão. Com TFT_PIPE_ASYNC definido em
+ * user_setting.h, tft_pipe_service() deve ser chamada pela interrupção de
+ * um timer; ela envia TFT_PIPE_CHUNK pixels por chamada enquanto a
+ * faixa seguinte é gerada. Nesse modo a função de render não pode
+ * desenhar na tela, apenas preencher as linhas recebidas.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_PIPE_H
+#define __TFT_PIPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#ifndef TFT_PIPE_BYTES
+#define TFT_PIPE_BYTES	4096	//RAM do buffer interno (as duas faixas juntas)
+#endif
+#ifndef TFT_PIPE_CHUNK
+#define TFT_PIPE_CHUNK	64		//pixels enviados por chamada de tft_pipe_service()
+#endif
+
+/* Tipos --------------------------------------------------------------------*/
+/**
+ * @brief Gera rows linhas de w pixels RGB565, começando na linha y da região
+ */
+typedef void (*tft_pipe_render_t)(uint16_t *band, int16_t y, int16_t rows, int16_t w, void *ctx);
+
+/* Protótipos de funções ---------------------------------------------------*/
+void tft_pipe_setBuffer(uint16_t *mem, uint32_t bytes);
+void tft_pipe_draw(int16_t x, int16_t y, int16_t w, int16_t h, tft_pipe_render_t render, void *ctx);
+void tft_pipe_service(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_PIPE_H */
@@ -0,0 +1,40 @@
+/**
+ ******************************************************************************
+ * @file    tft_pixconv.h
+ * @brief   Conversões de formato de pixel em bloco.
+ * 			RGB888, RGB565, RGB666 (3 bytes), RGB555, troca de R e B, troca
+ * 			de bytes e YUV 4:2:2 (câmera OV7670) para RGB565.
+ ******************************************************************************
+ * @attention
+ *
+ * As funções de 16 bits processam dois pixels por palavra de 32 bits e
+ * aceitam in == out (conversão no próprio buffer). No Cortex-M4 são usadas
+ * as instruções SIMD (__REV16, __UQADD8/__UQSUB8); em outras arquiteturas,
+ * código C equivalente com os mesmos resultados.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_PIXCONV_H
+#define __TFT_PIXCONV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Protótipos de funções ---------------------------------------------------*/
+void tft_rgb888_to_565(const uint8_t *in, uint16_t *out, uint32_t n);
+void tft_565_to_666(const uint16_t *in, uint8_t *out, uint32_t n);
+void tft_565_to_555(const uint16_t *in, uint16_t *out, uint32_t n);
+void tft_555_to_565(const uint16_t *in, uint16_t *out, uint32_t n);
+void tft_swapRB565(const uint16_t *in, uint16_t *out, uint32_t n);
+void tft_swapBytes16(const uint16_t *in, uint16_t *out, uint32_t n);
+void tft_yuv422_to_565(const uint8_t *in, uint16_t *out, uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_PIXCONV_H */
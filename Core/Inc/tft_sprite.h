@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ * @file    tft_sprite.h
+ * @brief   Sprites com cor transparente e restauração do fundo.
+ * 			O fundo sob o sprite é guardado (lido da GRAM) ou é uma cor fixa;
+ * 			ao mover, apenas a área descoberta (em "L") e a nova posição são
+ * 			enviadas ao LCD, sem apagar e redesenhar o sprite.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_SPRITE_H
+#define __TFT_SPRITE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define TFT_SPRITE_NOKEY	(-1)	//sprite sem cor transparente
+
+/* Tipos --------------------------------------------------------------------*/
+typedef struct {
+	const void *pixels;			///< RGB565 (uint16_t) ou índices (uint8_t) se palette != NULL
+	const uint16_t *palette;	///< Paleta RGB565 dos sprites indexados, NULL para RGB565
+	int16_t w, h;				///< Dimensões em pixels
+	int32_t key;				///< Cor (ou índice) transparente, TFT_SPRITE_NOKEY para nenhuma
+	uint16_t *background;		///< Buffer de w*h pixels para o fundo, NULL usa bgcolor
+	uint16_t bgcolor;			///< Cor de fundo quando não há buffer
+	int16_t x, y;				///< Posição atual (canto superior esquerdo)
+	uint8_t visible;
+} tft_sprite_t;
+
+/* Protótipos de funções ---------------------------------------------------*/
+void tft_sprite_init(tft_sprite_t *s, const void *pixels, const uint16_t *palette, int16_t w, int16_t h,
+		int32_t key, uint16_t *background, uint16_t bgcolor);
+void tft_sprite_show(tft_sprite_t *s, int16_t x, int16_t y);
+void tft_sprite_moveTo(tft_sprite_t *s, int16_t x, int16_t y);
+void tft_sprite_setImage(tft_sprite_t *s, const void *pixels);
+void tft_sprite_hide(tft_sprite_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_SPRITE_H */
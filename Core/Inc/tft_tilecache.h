@@ -0,0 +1,59 @@
+/**
+ ******************************************************************************
+ * @file    tft_tilecache.h
+ * @brief   Cache LRU em RAM de regiões já decodificadas dos recursos.
+ * 			Ícones e botões redesenhados a cada quadro são decodificados uma
+ * 			vez (RLE, QOI, JPEG) e as próximas vezes são copiados da RAM
+ * 			direto para o LCD, sem custo de decodificação.
+ ******************************************************************************
+ * @attention
+ *
+ * A chave é o id do recurso (tft_assets) e a região (sx, sy, w, h) dentro
+ * da imagem. As regiões ficam em uma área estática de TFT_TILECACHE_BYTES;
+ * quando falta espaço ou entrada livre, as menos usadas recentemente são
+ * descartadas. A região precisa caber na tela (w <= tft_width() e
+ * h <= tft_height()), pois a decodificação usa tft_setCapture().
+ ******************************************************************************
+ */
+
+#ifndef __TFT_TILECACHE_H
+#define __TFT_TILECACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+#include "tft_assets.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#ifndef TFT_TILECACHE_BYTES
+#define TFT_TILECACHE_BYTES		16384	//RAM para os pixels decodificados
+#endif
+#ifndef TFT_TILECACHE_SLOTS
+#define TFT_TILECACHE_SLOTS		16		//máximo de regiões guardadas
+#endif
+
+/* Tipos --------------------------------------------------------------------*/
+typedef struct {
+	uint32_t hits;					///< Regiões encontradas no cache
+	uint32_t misses;				///< Regiões decodificadas
+	uint32_t evictions;				///< Regiões descartadas para abrir espaço
+	uint32_t bytes;					///< RAM em uso
+	uint8_t tiles;					///< Regiões guardadas
+} tft_tilestats_t;
+
+/* Protótipos de funções ---------------------------------------------------*/
+const uint16_t *tft_tile_get(const tft_asset_t *a, int16_t sx, int16_t sy, int16_t w, int16_t h);
+int8_t tft_tile_draw(int16_t x, int16_t y, const tft_asset_t *a, int16_t sx, int16_t sy, int16_t w, int16_t h);
+int8_t tft_tile_drawAsset(int16_t x, int16_t y, const tft_asset_t *a);
+void tft_tile_flush(void);
+void tft_tile_stats(tft_tilestats_t *s);
+void tft_tile_resetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_TILECACHE_H */
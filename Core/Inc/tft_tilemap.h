@@ -0,0 +1,53 @@
+/**
+ ******************************************************************************
+ * @file    tft_tilemap.h
+ * @brief   Fundo formado por blocos (tile map) com redesenho seletivo.
+ * 			Os blocos ficam na flash como imagens indexadas de 8 bits; o mapa
+ * 			e as marcas de alteração ficam em RAM. Só as células alteradas
+ * 			são redesenhadas, blocos vizinhos na mesma linha compartilham uma
+ * 			janela e os blocos mais usados ficam expandidos em RGB565 na RAM.
+ ******************************************************************************
+ */
+
+#ifndef __TFT_TILEMAP_H
+#define __TFT_TILEMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#ifndef TFT_TILEMAP_TILE_MAX
+#define TFT_TILEMAP_TILE_MAX	16	//maior lado de bloco suportado
+#endif
+#ifndef TFT_TILEMAP_CACHE
+#define TFT_TILEMAP_CACHE		8	//blocos expandidos em RAM, TILE_MAX^2*2 bytes cada (0 desabilita)
+#endif
+
+/* Tipos --------------------------------------------------------------------*/
+typedef struct {
+	const uint8_t *tiles;		///< Blocos em flash, tw*th índices cada, em sequência
+	const uint16_t *palette;	///< Paleta RGB565 dos blocos
+	uint8_t tw, th;				///< Dimensões de um bloco (8x8, 16x16...)
+	uint8_t *map;				///< Número do bloco de cada célula, cols*rows bytes
+	uint8_t *dirty;				///< Marcas de alteração, (cols*rows+7)/8 bytes
+	uint16_t cols, rows;		///< Dimensões do mapa em células
+	int16_t x, y;				///< Posição do mapa na tela
+} tft_tilemap_t;
+
+/* Protótipos de funções ---------------------------------------------------*/
+void tft_tilemap_init(tft_tilemap_t *m, const uint8_t *tiles, const uint16_t *palette, uint8_t tw, uint8_t th,
+		uint8_t *map, uint8_t *dirty, uint16_t cols, uint16_t rows, int16_t x, int16_t y);
+void tft_tilemap_set(tft_tilemap_t *m, uint16_t col, uint16_t row, uint8_t tile);
+void tft_tilemap_invalidate(tft_tilemap_t *m, uint16_t col, uint16_t row, uint16_t ncols, uint16_t nrows);
+void tft_tilemap_draw(tft_tilemap_t *m);
+void tft_tilemap_cacheStats(uint32_t *hits, uint32_t *misses);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFT_TILEMAP_H */
@@ -30,6 +30,8 @@
 #define CS_PIN  	GPIO_PIN_0
 #define RESET_PORT 	GPIOC
 #define RESET_PIN  	GPIO_PIN_1
+//#define TE_PORT 	GPIOC          // saída TE do LCD (opcional, tft_setTearingSync)
+//#define TE_PIN  	GPIO_PIN_0
 
 #define D0_PORT 	GPIOA
 #define D0_PIN 		GPIO_PIN_9
@@ -176,4 +178,11 @@
 //#define SUPPORT_B509_7793         //R61509, ST7793 +244 bytes
 //#define OFFSET_9327 32            //costs about 103 bytes, 0.08s
 
+/* Módulos opcionais *********************************************************/
+/* Os módulos abaixo reservam RAM estática, habilite apenas os que forem usados */
+//#define TFT_USE_FB8               //canvas indexado de 8 bits, WIDTH*HEIGHT bytes (76,8 KB)
+//#define TFT_USE_FB4               //canvas indexado de 4 bits, WIDTH*HEIGHT/2 bytes (38,4 KB)
+//#define TFT_PIPE_ASYNC            //tft_pipe transmite pela interrupção de timer (tft_pipe_service)
+//#define TFT_GLYPH_CACHE_BYTES 8192 //caracteres prontos em RGB565 para tft_write_fillbackground (LRU)
+
 #endif /* USER_SETTING_H_ */
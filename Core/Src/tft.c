@@ -74,6 +74,8 @@
 
 /* Includes -----------------------------------------------------------------*/
 #include "tft.h"
+#include "tft_pixconv.h"
+#include "tft_alpha.h"
 //#include "stm32f4xx_hal.h"
 //#include "string.h"
 //#include "functions.h"
@@ -189,11 +191,21 @@ void PIN_OUTPUT (GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin)
 #define pgm_read_pointer(addr) ((void *)pgm_read_word(addr))
 
 #define min(a, b) (((a) < (b)) ? (a) : (b))
+#define max(a, b) (((a) > (b)) ? (a) : (b))
 #define _swap_int16_t(a, b) { int16_t t = a; a = b; b = t; }
 
 #define TFTLCD_DELAY 	0xFFFF
 #define TFTLCD_DELAY8 	0x7F
 
+#ifndef TFT_VSYNC_BAND
+#define TFT_VSYNC_BAND	32			//linhas escritas por sincronismo com a varredura
+#endif
+#ifndef TFT_VSYNC_LEAD
+#define TFT_VSYNC_LEAD	(HEIGHT / 2)	//distância máxima da varredura à frente da faixa
+#endif
+#define TFT_VSYNC_TIMEOUT	50		//ms, mais que dois quadros do painel
+#define TFT_CONV_CHUNK		32		//pixels convertidos por vez nos modos 555 e 18 bits
+
 /*****************************************************************************/
 
 /* Variáveis globais *********************************************************/
@@ -221,6 +233,16 @@ uint16_t  _lcd_xor, _lcd_capable;
 
 uint16_t _lcd_ID, _lcd_rev, _lcd_madctl, _lcd_drivOut, _MC, _MP, _MW, _SC, _EC, _SP, _EP;
 
+static const tft_target_t *target = NULL;	//NULL: desenha direto no LCD
+static struct {
+	uint16_t *buf;							//NULL: tft_startWrite() e tft_writeX() vão ao LCD
+	int16_t w, h;							//área capturada, a partir de (0, 0)
+	int16_t x, y, x0, x1, y1;				//posição de escrita e limites da janela aberta
+} capture;
+static const GFXfontAA *aaFont = NULL;	//fonte suavizada de tft_writeAA()
+static int16_t glyph_runs[258];				//fundo/frente alternados de uma linha de glifo (drawGlyphOpaque)
+static uint8_t vsync_enabled, vsync_busy;
+
 /* Protótopos de funções privadas ********************************************/
 static void pushColors16b(uint16_t * block, int16_t n, uint8_t first);
 static void pushColors8b(uint8_t * block, int16_t n, uint8_t first);
@@ -232,6 +254,8 @@ static void setWriteDir (void);
 
 static void pushColors_any(uint16_t cmd, uint8_t * block, int16_t n, uint8_t first, uint8_t flags);
 static void write24(uint16_t color);
+static void write565(uint16_t color);
+static void writeConverted(const uint16_t *block, uint32_t n);
 static void writecmddata(uint16_t cmd, uint16_t dat);
 static inline void WriteCmdParam4(uint8_t cmd, uint8_t d1, uint8_t d2, uint8_t d3, uint8_t d4);
 static void init_table(const void *table, int16_t size);
@@ -242,6 +266,10 @@ static uint32_t readReg32(uint16_t reg);
 static uint32_t readReg40(uint16_t reg);
 
 static void delay (uint32_t time);
+static void vsync_wait(int16_t y, int16_t h);
+static void capturePixel(uint16_t color);
+static int16_t bitRun(const uint8_t *row, int16_t stride, int16_t i, int16_t end, uint8_t set);
+static uint8_t sameBits(const uint8_t *bits, int16_t stride, int16_t a, int16_t b, int16_t n);
 
 /* Funções privadas **********************************************************/
 static uint16_t color565_to_555(uint16_t color)
@@ -249,11 +277,6 @@ static uint16_t color565_to_555(uint16_t color)
 	return (color & 0xFFC0) | ((color & 0x1F) << 1) | ((color & 0x01));  //lose Green LSB, extend Blue LSB
 }
 
-static uint16_t color555_to_565(uint16_t color)
-{
-	return (color & 0xFFC0) | ((color & 0x0400) >> 5) | ((color & 0x3F) >> 1); //extend Green LSB
-}
-
 static uint8_t color565_to_r(uint16_t color)
 {
 	return ((color & 0xF800) >> 8);  // transform to rrrrrxxx
@@ -274,6 +297,21 @@ static void pushCommand(uint16_t cmd, uint8_t * block, int8_t N)
 	WriteCmdParamN(cmd, N, block);
 }
 
+/**
+ * @brief Guarda um pixel da janela aberta no buffer de tft_setCapture() e avança
+ */
+static void capturePixel(uint16_t color)
+{
+	if (capture.y > capture.y1)
+		return;
+	if (capture.x >= 0 && capture.y >= 0 && capture.x < capture.w && capture.y < capture.h)
+		capture.buf[(int32_t)capture.y * capture.w + capture.x] = color;
+	if (++capture.x > capture.x1) {
+		capture.x = capture.x0;
+		capture.y++;
+	}
+}
+
 static void setReadDir (void)
 {
 	PIN_INPUT(D0_PORT, D0_PIN);
@@ -300,8 +338,7 @@ static void setWriteDir (void)
 
 static void pushColors_any(uint16_t cmd, uint8_t * block, int16_t n, uint8_t first, uint8_t flags)
 {
-	uint16_t color;
-	uint8_t h, l;
+	uint16_t buf[TFT_CONV_CHUNK];
 	uint8_t isconst = flags & 1;
 	uint8_t isbigend = (flags & 2) != 0;
 	CS_ACTIVE;
@@ -309,28 +346,23 @@ static void pushColors_any(uint16_t cmd, uint8_t * block, int16_t n, uint8_t fir
 		WriteCmd(cmd);
 	}
 
-	if (!isconst && !isbigend) {
+	if (!isconst && !isbigend && !is555 && !is9797) {
 		uint16_t *block16 = (uint16_t*)block;
 		while (n-- > 0) {
-			color = *block16++;
+			uint16_t color = *block16++;
 			write16(color);
 		}
 	} else
 
-		while (n-- > 0) {
-			if (isconst) {
-				h = pgm_read_byte(block++);
-				l = pgm_read_byte(block++);
-			} else {
-				h = (*block++);
-				l = (*block++);
-			}
-			color = (isbigend) ? (h << 8 | l) :  (l << 8 | h);
-#if defined(SUPPORT_9488_555)
-        		if (is555) color = color565_to_555(color);
-#endif
-if (is9797) write24(color); else
-	write16(color);
+		/* flash e RAM são mapeadas, então os dois casos são copiados em blocos */
+		while (n > 0) {
+			int16_t k = min(n, TFT_CONV_CHUNK);
+			memcpy(buf, block, k * sizeof(uint16_t));
+			if (isbigend)
+				tft_swapBytes16(buf, buf, k);
+			writeConverted(buf, k);
+			block += k * sizeof(uint16_t);
+			n -= k;
 		}
 	CS_IDLE;
 }
@@ -345,6 +377,58 @@ static void write24(uint16_t color)
 	write8(b);
 }
 
+/**
+ * @brief Escreve pixels RGB565 na janela aberta no formato do controlador
+ * @details Converte de TFT_CONV_CHUNK em TFT_CONV_CHUNK pixels com as funções em bloco de
+ * tft_pixconv (555 do ILI9488 ou 3 bytes RGB666) e só então envia os bytes.
+ *
+ * @param block pixels RGB565 (RAM ou flash)
+ * @param n quantidade de pixels
+ */
+static void writeConverted(const uint16_t *block, uint32_t n)
+{
+	uint16_t buf[TFT_CONV_CHUNK];
+	uint8_t rgb[3 * TFT_CONV_CHUNK];
+
+	while (n > 0) {
+		uint32_t k = min(n, TFT_CONV_CHUNK);
+		if (is9797) {
+			tft_565_to_666(block, rgb, k);
+			for (uint32_t i = 0; i < 3 * k; i++)
+				write8(rgb[i]);
+		} else {
+			const uint16_t *p = block;
+#if defined(SUPPORT_9488_555)
+			if (is555) {
+				tft_565_to_555(block, buf, k);
+				p = buf;
+			}
+#endif
+			for (uint32_t i = 0; i < k; i++) {
+				uint16_t color = p[i];
+				write16(color);
+			}
+		}
+		block += k;
+		n -= k;
+	}
+}
+
+/**
+ * @brief Escreve um pixel RGB565 na janela aberta convertendo para o formato do controlador
+ * @details Caminho lento usado quando o LCD opera em 555 (is555) ou 18 bits (is9797)
+ *
+ * @param color cor RGB565
+ */
+static void write565(uint16_t color)
+{
+#if defined(SUPPORT_9488_555)
+	if (is555) color = color565_to_555(color);
+#endif
+	if (is9797) write24(color); else
+		write16(color);
+}
+
 static void writecmddata(uint16_t cmd, uint16_t dat)
 {
 	CS_ACTIVE;
@@ -628,9 +712,6 @@ int16_t tft_readGRAM(int16_t x, int16_t y, uint16_t * block, int16_t w, int16_t
 				if (_lcd_capable & READ_BGR)
 					ret = (ret & 0x07E0) | (ret >> 11) | (ret << 11);
 			}
-#if defined(SUPPORT_9488_555)
-    		if (is555) ret = color555_to_565(ret);
-#endif
 *block++ = ret;
 n--;
 if (!(_lcd_capable & AUTO_READINC))
@@ -647,6 +728,10 @@ if (!(_lcd_capable & AUTO_READINC))
 	}
 	if (!(_lcd_capable & MIPI_DCS_REV1))
 		setAddrWindow(0, 0, width() - 1, height() - 1);
+#if defined(SUPPORT_9488_555)
+	if (is555)
+		tft_555_to_565(block - w * h, block - w * h, w * h);	//conversão em bloco após a leitura
+#endif
 	return 0;
 }
 
@@ -2988,6 +3073,10 @@ void tft_drawPixel(int16_t x, int16_t y, uint16_t color)
 	// MCUFRIEND just plots at edge if you try to write outside of the box:
 	if (x < 0 || y < 0 || x >= width() || y >= height())
 		return;
+	if (target) {
+		target->fillRect(x, y, 1, 1, color);
+		return;
+	}
 #if defined(SUPPORT_9488_555)
 	if (is555) color = color565_to_555(color);
 #endif
@@ -3215,6 +3304,10 @@ void tft_drawCircleHelper( int16_t x0, int16_t y0, int16_t r, uint8_t cornername
 
 void tft_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
 {
+	if (target && target->fillCircle) {
+		target->fillCircle(x0, y0, r, color);
+		return;
+	}
 	tft_drawFastVLine(x0, y0-r, 2*r+1, color);
 	tft_fillCircleHelper(x0, y0, r, 3, 0, color);
 }
@@ -3267,9 +3360,6 @@ void tft_drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 void tft_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 {
 	int16_t end;
-#if defined(SUPPORT_9488_555)
-	if (is555) color = color565_to_555(color);
-#endif
 	if (w < 0) {
 		w = -w;
 		x -= w;
@@ -3290,6 +3380,29 @@ void tft_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 	if (end > height())
 		end = height();
 	h = end - y;
+	if (w <= 0 || h <= 0)
+		return;
+	if (target) {
+		target->fillRect(x, y, w, h, color);
+		return;
+	}
+	if (vsync_enabled && !vsync_busy && h > TFT_VSYNC_BAND && rotation != 0) {
+		//A ordem de escrita não acompanha a varredura: um blanking e a região inteira
+		tft_waitVBlank();
+	} else if (vsync_enabled && !vsync_busy && h > TFT_VSYNC_BAND) {
+		//Escreve em faixas, cada uma logo atrás da varredura do painel
+		vsync_busy = 1;
+		for (end = y + h; y < end; y += TFT_VSYNC_BAND) {
+			int16_t band = (end - y < TFT_VSYNC_BAND) ? end - y : TFT_VSYNC_BAND;
+			vsync_wait(y, band);
+			tft_fillRect(x, y, w, band, color);
+		}
+		vsync_busy = 0;
+		return;
+	}
+#if defined(SUPPORT_9488_555)
+	if (is555) color = color565_to_555(color);
+#endif
 	setAddrWindow(x, y, x + w - 1, y + h - 1);
 	CS_ACTIVE;
 	WriteCmd(_MW);
@@ -3390,6 +3503,11 @@ void tft_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2
 {
 	int16_t a, b, y, last;
 
+	if (target && target->fillTriangle) {
+		target->fillTriangle(x0, y0, x1, y1, x2, y2, color);
+		return;
+	}
+
 	// Sort coordinates by Y order (y2 >= y1 >= y0)
 	if (y0 > y1) {
 		_swap_int16_t(y0, y1); _swap_int16_t(x0, x1);
@@ -3674,7 +3792,7 @@ void tft_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_
 				h  = pgm_read_byte(&glyph->height);
 		int8_t   xo = pgm_read_byte(&glyph->xOffset),
 				yo = pgm_read_byte(&glyph->yOffset);
-		uint8_t  xx, yy, bits = 0, bit = 0;
+		uint8_t  xx, yy, rows;
 		int16_t  xo16 = 0, yo16 = 0;
 
 		if(size > 1) {
@@ -3682,20 +3800,27 @@ void tft_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_
 			yo16 = yo;
 		}
 
-		for(yy=0; yy<h; yy++) {
-			for(xx=0; xx<w; xx++) {
-				if(!(bit++ & 7)) {
-					bits = pgm_read_byte(&bitmap[bo++]);
-				}
-				if(bits & 0x80) {
+		// Os bits do glifo são contínuos (as linhas não começam em um byte novo).
+		// Cada sequência de bits 1 de uma linha vira um único retângulo, que cobre
+		// também as linhas seguintes iguais a ela (traços verticais dos dígitos).
+		const uint8_t *bits = &bitmap[bo];
+		int16_t stride = ((uint16_t)w * h + 7) >> 3;
+		for(yy=0; yy<h; yy+=rows) {
+			int16_t i = yy * w, end = i + w;
+			for(rows=1; yy+rows<h && sameBits(bits, stride, i, (yy+rows) * w, w); rows++);
+			while(i < end) {
+				i += bitRun(bits, stride, i, end, 0);
+				int16_t n = bitRun(bits, stride, i, end, 1);
+				if(n) {
+					xx = i - yy * w;
 					if(size == 1) {
-						writePixel(x+xo+xx, y+yo+yy, color);
+						tft_fillRect(x+xo+xx, y+yo+yy, n, rows, color);
 					} else {
 						tft_fillRect(x+(xo16+xx)*size, y+(yo16+yy)*size,
-								size, size, color);
+								n*size, rows*size, color);
 					}
 				}
-				bits <<= 1;
+				i += n;
 			}
 		}
 
@@ -3740,6 +3865,226 @@ size_t tft_write(uint8_t c)
 	return 1;
 }
 
+/**
+ * @brief Desenha a célula de um caractere (fundo e glifo) em uma única janela
+ * @details A janela cobre a célula (cx, cy, cw, ch), recortada uma vez pela tela, e
+ * cada linha é enviada em sequências de cor de frente/fundo lidas direto dos bits do
+ * GFXglyph, sem tft_fillRect() prévio nem uma janela por pixel. Com size > 1 cada
+ * linha do glifo é repetida size vezes e cada bit vira size pixels na mesma
+ * sequência. Pixels do glifo fora da célula, se houver, são desenhados depois.
+ *
+ * @param x,y cursor (linha de base) do caractere
+ * @param glyph glifo da fonte atual
+ * @param cx,cy,cw,ch célula em pixels de tela
+ * @param color cor do caractere
+ * @param bg cor de fundo
+ * @param size fator de escala
+ */
+static void drawGlyphOpaque(int16_t x, int16_t y, const GFXglyph *glyph, int16_t cx, int16_t cy, int16_t cw,
+		int16_t ch, uint16_t color, uint16_t bg, uint8_t size)
+{
+	uint16_t bo = pgm_read_word(&glyph->bitmapOffset);
+	const uint8_t *bitmap = (const uint8_t *)pgm_read_pointer(&gfxFont->bitmap) + bo;
+	uint8_t w = pgm_read_byte(&glyph->width), gh = pgm_read_byte(&glyph->height);
+	int16_t gx0 = x + (int8_t)pgm_read_byte(&glyph->xOffset) * size;
+	int16_t gy0 = y + (int8_t)pgm_read_byte(&glyph->yOffset) * size;
+	int16_t gx1 = gx0 + w * size, gy1 = gy0 + gh * size;
+	int16_t vx0 = max(cx, 0), vy0 = max(cy, 0);
+	int16_t vx1 = min(cx + cw, _width), vy1 = min(cy + ch, _height);
+
+	if (vx0 < vx1 && vy0 < vy1) {
+		/* colunas do glifo visíveis na célula */
+		int16_t c0 = (max(gx0, vx0) - gx0) / size;
+		int16_t c1 = (min(gx1, vx1) - gx0 + size - 1) / size;
+		int16_t stride = ((uint16_t)w * gh + 7) >> 3, last = -1;
+		uint16_t nruns = 0;
+
+		tft_startWrite(vx0, vy0, vx1 - vx0, vy1 - vy0);
+		for (int16_t py = vy0; py < vy1; py++) {
+			if (py < gy0 || py >= gy1 || c0 >= c1) {
+				tft_writeColor(bg, vx1 - vx0);
+				continue;
+			}
+			/* as sequências de uma linha do glifo são calculadas uma vez e
+			   repetidas nas size linhas da tela que ela ocupa */
+			int16_t gr = (py - gy0) / size;
+			if (gr != last) {
+				int16_t i = gr * w + c0, end = gr * w + c1, pos = vx0;
+				uint8_t set = 0;
+				nruns = 0;
+				while (i < end) {
+					int16_t n = bitRun(bitmap, stride, i, end, set);
+					int16_t next = max(pos, min(gx0 + (i + n - gr * w) * size, vx1));
+					glyph_runs[nruns++] = next - pos;
+					pos = next;
+					set ^= 1;
+					i += n;
+				}
+				if (nruns & 1)
+					glyph_runs[nruns - 1] += vx1 - pos;
+				else
+					glyph_runs[nruns++] = vx1 - pos;
+				last = gr;
+			}
+			for (uint16_t k = 0; k < nruns; k++)
+				if (glyph_runs[k])
+					tft_writeColor((k & 1) ? color : bg, glyph_runs[k]);
+		}
+		tft_endWrite();
+	}
+
+	/* partes do glifo que passam da célula */
+	if (gx0 >= cx && gy0 >= cy && gx1 <= cx + cw && gy1 <= cy + ch)
+		return;
+	for (uint32_t idx = 0, n = (uint32_t)w * gh; idx < n; idx++) {
+		int16_t px = gx0 + (idx % w) * size, py = gy0 + (idx / w) * size;
+		if ((bitmap[idx >> 3] & (0x80 >> (idx & 7))) &&
+				(px < cx || py < cy || px >= cx + cw || py >= cy + ch))
+			tft_fillRect(px, py, size, size, color);
+	}
+}
+
+/****************** Cache de glifos *************/
+#if defined(TFT_GLYPH_CACHE_BYTES)
+
+#ifndef TFT_GLYPH_CACHE_SLOTS
+#define TFT_GLYPH_CACHE_SLOTS	32		//máximo de caracteres guardados
+#endif
+
+typedef struct {
+	const GFXfont *font;
+	uint16_t color, bg;
+	uint8_t c, size;
+	int16_t w, h;					//célula em pixels
+	uint32_t offset, npix;			//posição e tamanho na área, em pixels
+	uint32_t used;					//instante do último uso
+} glyph_slot_t;
+
+static uint16_t glyph_arena[TFT_GLYPH_CACHE_BYTES / sizeof(uint16_t)];
+static glyph_slot_t glyph_slots[TFT_GLYPH_CACHE_SLOTS];
+static uint8_t glyph_count;
+static uint32_t glyph_top, glyph_now, glyph_hits, glyph_misses;
+
+/**
+ * @brief Descarta o caractere usado há mais tempo e compacta a área
+ */
+static void glyphEvict(void)
+{
+	uint8_t old = 0;
+
+	for (uint8_t i = 1; i < glyph_count; i++)
+		if (glyph_now - glyph_slots[i].used > glyph_now - glyph_slots[old].used)
+			old = i;
+	uint32_t npix = glyph_slots[old].npix, end = glyph_slots[old].offset + npix;
+	memmove(&glyph_arena[end - npix], &glyph_arena[end], (glyph_top - end) * sizeof(uint16_t));
+	glyph_top -= npix;
+	for (uint8_t i = old + 1; i < glyph_count; i++) {
+		glyph_slots[i].offset -= npix;
+		glyph_slots[i - 1] = glyph_slots[i];
+	}
+	glyph_count--;
+}
+
+/**
+ * @brief Desenha a célula de um caractere a partir do cache, renderizando-a na falta
+ * @details A chave é (fonte, caractere, escala, cor, fundo). Um acerto é uma única
+ * janela e tft_writeColors() da RAM. Caracteres cujo glifo passa da célula ou que
+ * não cabem na área não são guardados.
+ *
+ * @return 1 se desenhado, 0 se o caractere deve ser desenhado por drawGlyphOpaque()
+ */
+static uint8_t drawGlyphCached(int16_t x, int16_t y, const GFXglyph *glyph, uint8_t c, int16_t cx, int16_t cy,
+		int16_t cw, int16_t ch, uint16_t color, uint16_t bg, uint8_t size)
+{
+	glyph_slot_t *s = NULL;
+
+	if (capture.buf)
+		return 0;
+	glyph_now++;
+	for (uint8_t i = 0; i < glyph_count; i++) {
+		glyph_slot_t *t = &glyph_slots[i];
+		if (t->c == c && t->font == gfxFont && t->size == size && t->color == color && t->bg == bg) {
+			s = t;
+			glyph_hits++;
+			break;
+		}
+	}
+
+	if (!s) {
+		int16_t gx0 = x + (int8_t)pgm_read_byte(&glyph->xOffset) * size;
+		int16_t gy0 = y + (int8_t)pgm_read_byte(&glyph->yOffset) * size;
+		uint32_t npix = ((uint32_t)cw * ch + 1) & ~1u;
+		if (cw > _width || ch > _height || npix > sizeof(glyph_arena) / sizeof(uint16_t) || gx0 < cx || gy0 < cy ||
+				gx0 + pgm_read_byte(&glyph->width) * size > cx + cw ||
+				gy0 + pgm_read_byte(&glyph->height) * size > cy + ch)
+			return 0;
+		glyph_misses++;
+		while (glyph_count && (glyph_count == TFT_GLYPH_CACHE_SLOTS ||
+				glyph_top + npix > sizeof(glyph_arena) / sizeof(uint16_t)))
+			glyphEvict();
+
+		s = &glyph_slots[glyph_count++];
+		s->font = gfxFont;
+		s->c = c;
+		s->size = size;
+		s->color = color;
+		s->bg = bg;
+		s->w = cw;
+		s->h = ch;
+		s->offset = glyph_top;
+		s->npix = npix;
+		glyph_top += npix;
+		/* renderiza a célula em (0, 0) direto na área */
+		tft_setCapture(&glyph_arena[s->offset], cw, ch);
+		drawGlyphOpaque(x - cx, y - cy, glyph, 0, 0, cw, ch, color, bg, size);
+		tft_setCapture(NULL, 0, 0);
+	}
+	s->used = glyph_now;
+
+	/* cópia da RAM para o LCD, recortada pela tela */
+	const uint16_t *px = &glyph_arena[s->offset];
+	int16_t w = cw, h = ch;
+	if (cx < 0) { px -= cx; w += cx; cx = 0; }
+	if (cy < 0) { px -= (int32_t)cy * s->w; h += cy; cy = 0; }
+	if (cx + w > _width) w = _width - cx;
+	if (cy + h > _height) h = _height - cy;
+	if (w <= 0 || h <= 0)
+		return 1;
+	tft_startWrite(cx, cy, w, h);
+	if (w == s->w) {
+		tft_writeColors(px, (uint32_t)w * h);
+	} else {
+		for (int16_t r = 0; r < h; r++, px += s->w)
+			tft_writeColors(px, w);
+	}
+	tft_endWrite();
+	return 1;
+}
+
+/**
+ * @brief Contadores do cache de glifos (taxa de acerto = hits / (hits + misses))
+ *
+ * @param hits caracteres desenhados a partir do cache
+ * @param misses caracteres renderizados e guardados
+ */
+void tft_glyphCacheStats(uint32_t *hits, uint32_t *misses)
+{
+	*hits = glyph_hits;
+	*misses = glyph_misses;
+}
+
+/**
+ * @brief Esvazia o cache de glifos e zera os contadores
+ */
+void tft_glyphCacheFlush(void)
+{
+	glyph_count = 0;
+	glyph_top = 0;
+	glyph_hits = glyph_misses = 0;
+}
+
+#endif /* TFT_GLYPH_CACHE_BYTES */
+
 /*!
     @brief  Print one byte/character of data, used to support print()
     				print the background first with the textbgcolor
@@ -3766,20 +4111,16 @@ size_t tft_write_fillbackground(uint8_t c)
 			//Se o caractere a ser escrito é válido
 			if((c >= first) && (c <= (uint8_t)pgm_read_byte(&gfxFont->last)))
 			{
-				//Modificação: Desenha um retângulo preenchido com a cor de fundo com as dimensões
-				//máximas ocupado por um caractere.
+				//Modificação: O fundo é a célula com as dimensões máximas ocupadas por um caractere.
 				//Neste estudo, para as fontes do tipo mono_x_ os caracaters '\' e '/' tem as maiores dimensões.
 				uint8_t maior = '/';
 				//Preenche o ponteiro para struct glyph com os parâmetros do caractere '\'
 				GFXglyph *glyph2 = &(((GFXglyph *)pgm_read_pointer(
 						&gfxFont->glyph))[maior - first]);
-				//Desenha o retângulo cobrinto toda a área do maior carctere possível
-				int16_t xx = cursor_x;
+				//Dimensões da célula que cobre toda a área do maior carctere possível
 				int8_t yo = pgm_read_byte(&glyph2->yOffset);
-				int16_t yy = (int16_t)cursor_y + yo*textsize;
 				int16_t ww = pgm_read_byte(&glyph2->xAdvance) * textsize;
 				int16_t hh = pgm_read_byte(&glyph2->height)*textsize;
-				tft_fillRect(xx, yy, ww, hh, textbgcolor);
 
 				//Preenche o ponteiro para struct glyph com os parâmetros do caractere
 				GFXglyph *glyph = &(((GFXglyph *)pgm_read_pointer(
@@ -3798,17 +4139,20 @@ size_t tft_write_fillbackground(uint8_t c)
 						cursor_x  = 0;
 						cursor_y += (int16_t)textsize *
 								(uint8_t)pgm_read_byte(&gfxFont->yAdvance);
-
-						//Modificação: Se precisou quebrar a linha, desenha um novo retângulo
-						//na linha seguinte
-						//Desenha o retângulo cobrinto toda a área do maior carctere possível
-						xx = cursor_x;
-						yy = (int16_t)cursor_y + yo*textsize;
-						tft_fillRect(xx, yy, ww, hh, textbgcolor);
 					}
-					//Desenha o caractere
-					tft_drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
-					//tft_drawCharLF(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
+				}
+				//Desenha o fundo e o caractere. No LCD é uma única janela sobre a célula;
+				//com um alvo em RAM o retângulo e os pixels passam pelo alvo.
+				int16_t yy = (int16_t)cursor_y + yo*textsize;
+				if (target) {
+					tft_fillRect(cursor_x, yy, ww, hh, textbgcolor);
+					if((w > 0) && (h > 0))
+						tft_drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
+				} else {
+#if defined(TFT_GLYPH_CACHE_BYTES)
+					if (!drawGlyphCached(cursor_x, cursor_y, glyph, c, cursor_x, yy, ww, hh, textcolor, textbgcolor, textsize))
+#endif
+					drawGlyphOpaque(cursor_x, cursor_y, glyph, cursor_x, yy, ww, hh, textcolor, textbgcolor, textsize);
 				}
 				//Avança o cursor de acordo com a largura reservada para o caractere
 				cursor_x += (uint8_t)pgm_read_byte(&glyph->xAdvance) * (int16_t)textsize;
@@ -4194,6 +4538,21 @@ void tft_drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w,
 		y = _height - 1;
 	}
 
+	if (target) {
+		//O alvo recebe as linhas já recortadas, sempre de cima para baixo
+		for(int16_t row = 0; row < h; row++)
+		{
+			target->writeRect(x, y-h+1+row, w, 1, &bitmap[i]);
+			i = i + w + skipC;
+		}
+		return;
+	}
+
+	int16_t left = x, top = y-h+1;
+
+	if (vsync_enabled && h > TFT_VSYNC_BAND)
+		vsync_wait(top, TFT_VSYNC_BAND);
+
 	setAddrWindow(x, y-h+1, x+w-1, y);
 
 	tft_inicioDados();
@@ -4203,6 +4562,14 @@ void tft_drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w,
 	//Dessa forma, uma imagem normal fica na orientação correta
 	for(y=0; y<h; y=y+1)
 	{
+		if (vsync_enabled && rotation == 0 && y > 0 && (y % TFT_VSYNC_BAND) == 0)
+		{
+			//Nova faixa: a leitura da varredura interrompe a escrita na GRAM
+			tft_fimDados();
+			vsync_wait(top+y, (h-y < TFT_VSYNC_BAND) ? h-y : TFT_VSYNC_BAND);
+			setAddrWindow(left, top+y, left+w-1, top+h-1);
+			tft_inicioDados();
+		}
 		for(x=0; x<w; x=x+1)
 		{
 			write16(bitmap[i]);
@@ -4229,3 +4596,691 @@ void tft_drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w,
 
 	tft_fimDados();
 }
+
+/****************** Bitmaps indexados *************/
+
+/**
+ * @brief Lê o pixel i de uma linha empacotada (pixel mais à esquerda nos bits altos)
+ */
+static inline uint8_t packedPixel(const uint8_t *row, int16_t i, uint8_t bpp)
+{
+	switch (bpp) {
+	case 1:  return (row[i >> 3] >> (7 - (i & 7))) & 0x01;
+	case 2:  return (row[i >> 2] >> ((3 - (i & 3)) << 1)) & 0x03;
+	case 4:  return (row[i >> 1] >> ((~i & 1) << 2)) & 0x0F;
+	default: return row[i];
+	}
+}
+
+/**
+ * @brief Expande n pixels empacotados, a partir do pixel first da linha, na janela aberta
+ */
+static void writePacked(const uint8_t *row, int16_t first, uint8_t bpp, const uint16_t *palette, int16_t n)
+{
+	if (bpp == 8) {
+		tft_writeIndexed8(row + first, palette, n);
+		return;
+	}
+	if (bpp == 4) {
+		tft_writeIndexed4(row + (first >> 1), first & 1, palette, n);
+		return;
+	}
+
+	uint8_t mask = (1 << bpp) - 1, ppb = 8 / bpp;
+	const uint8_t *p = row + first / ppb;
+	int8_t shift = 8 - bpp - (first % ppb) * bpp;
+	uint8_t bits = *p;
+
+	while (n-- > 0) {
+		uint16_t color = palette[(bits >> shift) & mask];
+		if (is555 || is9797)
+			write565(color);
+		else
+			write16(color);
+		shift -= bpp;
+		if (shift < 0 && n > 0) {
+			bits = *++p;
+			shift = 8 - bpp;
+		}
+	}
+}
+
+/**
+ * @brief Envia um trecho de linha indexada para o alvo de desenho, em blocos
+ */
+static void targetPacked(int16_t x, int16_t y, const uint8_t *row, int16_t first, uint8_t bpp,
+		const uint16_t *palette, int16_t n)
+{
+	uint16_t line[64];
+
+	while (n > 0) {
+		int16_t k = (n < 64) ? n : 64;
+		for (int16_t i = 0; i < k; i++)
+			line[i] = palette[packedPixel(row, first + i, bpp)];
+		target->writeRect(x, y, k, 1, line);
+		x += k;
+		first += k;
+		n -= k;
+	}
+}
+
+/**
+ * @brief Desenha um bitmap indexado de 1, 2, 4 ou 8 bits por pixel
+ * @details Cada linha começa em um byte novo e o pixel mais à esquerda fica nos
+ * bits mais altos. Sem cor transparente a imagem vai em uma única janela;
+ * com transparente, cada trecho opaco de cada linha vai em sua própria janela.
+ *
+ * @param x,y canto superior esquerdo (pode estar fora da tela)
+ * @param bitmap pixels empacotados
+ * @param w,h dimensões em pixels
+ * @param bpp bits por pixel: 1, 2, 4 ou 8
+ * @param palette paleta RGB565 com 2^bpp cores
+ * @param key índice transparente ou -1
+ */
+void tft_drawIndexedBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint8_t bpp,
+		const uint16_t *palette, int16_t key)
+{
+	int16_t stride = ((int32_t)w * bpp + 7) >> 3;
+	int16_t x0 = 0, y0 = 0;
+
+	if (bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8)
+		return;
+	if (x < 0) { x0 = -x; w += x; x = 0; }
+	if (y < 0) { y0 = -y; h += y; y = 0; }
+	if (x + w > _width) w = _width - x;
+	if (y + h > _height) h = _height - y;
+	if (w <= 0 || h <= 0)
+		return;
+
+	const uint8_t *row = bitmap + (int32_t)y0 * stride;
+
+	if (key < 0) {
+		if (target) {
+			for (int16_t r = 0; r < h; r++, row += stride)
+				targetPacked(x, y + r, row, x0, bpp, palette, w);
+			return;
+		}
+		tft_startWrite(x, y, w, h);
+		for (int16_t r = 0; r < h; r++, row += stride)
+			writePacked(row, x0, bpp, palette, w);
+		tft_endWrite();
+		return;
+	}
+
+	for (int16_t r = 0; r < h; r++, row += stride) {
+		int16_t i = 0;
+		while (i < w) {
+			while (i < w && packedPixel(row, x0 + i, bpp) == key)
+				i++;
+			int16_t start = i;
+			while (i < w && packedPixel(row, x0 + i, bpp) != key)
+				i++;
+			if (i == start)
+				continue;
+			if (target) {
+				targetPacked(x + start, y + r, row, x0 + start, bpp, palette, i - start);
+			} else {
+				tft_startWrite(x + start, y + r, i - start, 1);
+				writePacked(row, x0 + start, bpp, palette, i - start);
+				tft_endWrite();
+			}
+		}
+	}
+}
+
+/****************** Bitmaps de 1 bit *************/
+
+/**
+ * @brief Lê 32 pixels de uma linha de 1 bpp a partir do pixel i, o pixel i no bit 31
+ * @details Os bytes além do fim da linha são lidos como zero.
+ */
+static inline uint32_t rowBits(const uint8_t *row, int16_t stride, int16_t i)
+{
+	const uint8_t *p = row + (i >> 3);
+	int16_t left = stride - (i >> 3);
+	uint32_t v = 0;
+	uint8_t extra;
+
+	for (uint8_t k = 0; k < 4; k++)
+		v = (v << 8) | ((k < left) ? p[k] : 0);
+	extra = (4 < left) ? p[4] : 0;
+	if (i & 7)
+		v = (v << (i & 7)) | (extra >> (8 - (i & 7)));
+	return v;
+}
+
+/**
+ * @brief Conta quantos pixels a partir de i (até end) têm o valor set, 32 por vez com CLZ
+ */
+static int16_t bitRun(const uint8_t *row, int16_t stride, int16_t i, int16_t end, uint8_t set)
+{
+	int16_t start = i;
+
+	while (i < end) {
+		uint32_t v = rowBits(row, stride, i);
+		uint8_t k = __CLZ(set ? ~v : v);
+		i += k;
+		if (k < 32)
+			break;
+	}
+	return ((i < end) ? i : end) - start;
+}
+
+/**
+ * @brief Compara n bits a partir dos bits a e b, 32 por vez
+ */
+static uint8_t sameBits(const uint8_t *bits, int16_t stride, int16_t a, int16_t b, int16_t n)
+{
+	for (; n > 0; n -= 32, a += 32, b += 32) {
+		uint32_t d = rowBits(bits, stride, a) ^ rowBits(bits, stride, b);
+		if (n < 32)
+			d &= ~(0xFFFFFFFFu >> n);
+		if (d)
+			return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief Desenha um bitmap de 1 bit por pixel (XBM/logotipos, MSB à esquerda)
+ * @details Cada linha começa em um byte novo. Opaco: a imagem vai em uma única
+ * janela e cada sequência de bits iguais é uma repetição de fg ou bg.
+ * Transparente: só as sequências de bits 1 viram retângulos de altura 1.
+ * As sequências são encontradas 32 bits por vez com a instrução CLZ.
+ *
+ * @param x,y canto superior esquerdo (pode estar fora da tela)
+ * @param bitmap bits da imagem
+ * @param w,h dimensões em pixels
+ * @param fg cor dos bits 1
+ * @param bg cor dos bits 0 ou -1 para transparente
+ */
+void tft_drawBitmap1(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t fg, int32_t bg)
+{
+	int16_t stride = (w + 7) >> 3;
+	int16_t x0 = 0, y0 = 0;
+
+	if (x < 0) { x0 = -x; w += x; x = 0; }
+	if (y < 0) { y0 = -y; h += y; y = 0; }
+	if (x + w > _width) w = _width - x;
+	if (y + h > _height) h = _height - y;
+	if (w <= 0 || h <= 0)
+		return;
+
+	const uint8_t *row = bitmap + (int32_t)y0 * stride;
+	int16_t end = x0 + w;
+
+	if (bg < 0) {
+		for (int16_t r = 0; r < h; r++, row += stride) {
+			int16_t i = x0;
+			while (i < end) {
+				i += bitRun(row, stride, i, end, 0);
+				int16_t n = bitRun(row, stride, i, end, 1);
+				if (n)
+					tft_fillRect(x + i - x0, y + r, n, 1, fg);
+				i += n;
+			}
+		}
+		return;
+	}
+
+	if (!target)
+		tft_startWrite(x, y, w, h);
+	for (int16_t r = 0; r < h; r++, row += stride) {
+		int16_t i = x0;
+		while (i < end) {
+			uint8_t set = (row[i >> 3] >> (7 - (i & 7))) & 1;
+			int16_t n = bitRun(row, stride, i, end, set);
+			uint16_t color = set ? fg : (uint16_t)bg;
+			if (target)
+				target->fillRect(x + i - x0, y + r, n, 1, color);
+			else
+				tft_writeColor(color, n);
+			i += n;
+		}
+	}
+	if (!target)
+		tft_endWrite();
+}
+
+/****************** Fontes suavizadas de 4 bits *************/
+
+/**
+ * @brief Tabela com as 16 misturas de color sobre bg, refeita só quando o par muda
+ */
+static const uint16_t *aaLut(uint16_t color, uint16_t bg)
+{
+	static uint16_t lut[16], lut_color, lut_bg;
+	static uint8_t lut_ready;
+
+	if (!lut_ready || color != lut_color || bg != lut_bg) {
+		for (uint8_t k = 0; k < 16; k++)
+			lut[k] = tft_blend565(color, bg, k * 17);
+		lut_color = color;
+		lut_bg = bg;
+		lut_ready = 1;
+	}
+	return lut;
+}
+
+/**
+ * @brief Seleciona a fonte suavizada usada por tft_writeAA() e tft_drawCharAA()
+ *
+ * @param f fonte gerada por Tools/fontconvert_aa.c
+ */
+void tft_setFontAA(const GFXfontAA *f)
+{
+	aaFont = f;
+}
+
+/**
+ * @brief Desenha um caractere da fonte suavizada misturado sobre a cor de fundo
+ * @details A cobertura de 4 bits de cada pixel indexa a tabela de misturas de
+ * color/bg e o glifo vai em uma única janela por tft_writeIndexed4(), com o mesmo
+ * custo por pixel do texto de 1 bit com fundo. Só o retângulo do glifo é escrito.
+ * Sem escala (textsize não é usado).
+ *
+ * @param x,y cursor (linha de base) do caractere
+ * @param c caractere
+ * @param color cor do texto
+ * @param bg cor de fundo sob o texto
+ */
+void tft_drawCharAA(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg)
+{
+	if (!aaFont || c < aaFont->first || c > aaFont->last)
+		return;
+
+	const GFXglyph *glyph = &aaFont->glyph[c - aaFont->first];
+	const uint8_t *bits = aaFont->bitmap + (uint16_t)pgm_read_word(&glyph->bitmapOffset);
+	int16_t w = pgm_read_byte(&glyph->width), h = pgm_read_byte(&glyph->height), stride = w;
+	int16_t x0 = 0, y0 = 0;
+
+	x += (int8_t)pgm_read_byte(&glyph->xOffset);
+	y += (int8_t)pgm_read_byte(&glyph->yOffset);
+	if (x < 0) { x0 = -x; w += x; x = 0; }
+	if (y < 0) { y0 = -y; h += y; y = 0; }
+	if (x + w > _width) w = _width - x;
+	if (y + h > _height) h = _height - y;
+	if (w <= 0 || h <= 0)
+		return;
+
+	const uint16_t *lut = aaLut(color, bg);
+	uint32_t i = (uint32_t)y0 * stride + x0;
+
+	if (target) {
+		for (int16_t r = 0; r < h; r++, i += stride)
+			targetPacked(x, y + r, bits + (i >> 1), i & 1, 4, lut, w);
+		return;
+	}
+	tft_startWrite(x, y, w, h);
+	if (w == stride) {
+		tft_writeIndexed4(bits + (i >> 1), i & 1, lut, (uint32_t)w * h);
+	} else {
+		for (int16_t r = 0; r < h; r++, i += stride)
+			tft_writeIndexed4(bits + (i >> 1), i & 1, lut, w);
+	}
+	tft_endWrite();
+}
+
+/**
+ * @brief Escreve um caractere da fonte suavizada no cursor, como tft_write()
+ * @details Usa textcolor e textbgcolor (tft_setTextColor()/tft_setTextBackColor())
+ * e respeita a quebra automática de linha.
+ *
+ * @param c caractere
+ * @return 1
+ */
+size_t tft_writeAA(uint8_t c)
+{
+	if (!aaFont)
+		return 1;
+	if (c == '\n') {
+		cursor_x = 0;
+		cursor_y += (uint8_t)pgm_read_byte(&aaFont->yAdvance);
+	} else if (c != '\r' && c >= aaFont->first && c <= aaFont->last) {
+		const GFXglyph *glyph = &aaFont->glyph[c - aaFont->first];
+		uint8_t w = pgm_read_byte(&glyph->width), h = pgm_read_byte(&glyph->height);
+		if (w > 0 && h > 0) {
+			int16_t xo = (int8_t)pgm_read_byte(&glyph->xOffset);
+			if (wrap && ((cursor_x + xo + w) > _width)) {
+				cursor_x = 0;
+				cursor_y += (uint8_t)pgm_read_byte(&aaFont->yAdvance);
+			}
+			tft_drawCharAA(cursor_x, cursor_y, c, textcolor, textbgcolor);
+		}
+		cursor_x += (uint8_t)pgm_read_byte(&glyph->xAdvance);
+	}
+	return 1;
+}
+
+/**
+ * @brief Escreve uma string com a fonte suavizada a partir do cursor
+ *
+ * @param str string terminada em zero
+ */
+void tft_printstrAA(uint8_t *str)
+{
+	while (*str) tft_writeAA(*str++);
+}
+
+/****************** Alvo de desenho e escrita em bloco *************/
+
+/**
+ * @brief Redireciona as primitivas de desenho para um alvo em RAM
+ * @details tft_fillRect(), tft_drawPixel() e tft_drawRGBBitmap() passam a chamar as
+ * funções do alvo, portanto todas as primitivas e o texto também são redirecionados.
+ *
+ * @param t alvo de desenho ou NULL para voltar a desenhar direto no LCD
+ */
+void tft_setTarget(const tft_target_t *t)
+{
+	target = t;
+}
+
+/**
+ * @brief Retorna o alvo de desenho instalado
+ *
+ * @return alvo atual ou NULL quando o desenho vai direto para o LCD
+ */
+const tft_target_t *tft_getTarget(void)
+{
+	return target;
+}
+
+/**
+ * @brief Largura da tela na rotação atual
+ */
+int16_t tft_width(void)
+{
+	return _width;
+}
+
+/**
+ * @brief Altura da tela na rotação atual
+ */
+int16_t tft_height(void)
+{
+	return _height;
+}
+
+/**
+ * @brief Abre uma janela no LCD e inicia a escrita de pixels na GRAM
+ * @details A janela não é recortada, quem chama deve garantir que está dentro da tela.
+ * Deve ser seguida de tft_writeColors()/tft_writeColor() e finalizada com tft_endWrite().
+ *
+ * @param x coluna do canto superior esquerdo
+ * @param y linha do canto superior esquerdo
+ * @param w largura da janela
+ * @param h altura da janela
+ */
+void tft_startWrite(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (capture.buf) {
+		capture.x = capture.x0 = x;
+		capture.y = y;
+		capture.x1 = x + w - 1;
+		capture.y1 = y + h - 1;
+		return;
+	}
+	setAddrWindow(x, y, x + w - 1, y + h - 1);
+	CS_ACTIVE;
+	WriteCmd(_MW);
+}
+
+/**
+ * @brief Escreve um bloco de pixels RGB565 na janela aberta por tft_startWrite()
+ *
+ * @param block pixels RGB565 (RAM ou flash)
+ * @param n quantidade de pixels
+ */
+void tft_writeColors(const uint16_t *block, uint32_t n)
+{
+	if (capture.buf) {
+		while (n-- > 0)
+			capturePixel(*block++);
+		return;
+	}
+	if (is555 || is9797) {
+		writeConverted(block, n);
+		return;
+	}
+	while (n-- > 0) {
+		uint16_t color = *block++;
+		write16(color);
+	}
+}
+
+/**
+ * @brief Repete uma mesma cor n vezes na janela aberta por tft_startWrite()
+ *
+ * @param color cor RGB565
+ * @param n quantidade de pixels
+ */
+void tft_writeColor(uint16_t color, uint32_t n)
+{
+	if (capture.buf) {
+		while (n-- > 0)
+			capturePixel(color);
+		return;
+	}
+	if (is555 || is9797) {
+		while (n-- > 0)
+			write565(color);
+		return;
+	}
+	uint8_t hi = color >> 8, lo = color & 0xFF;
+	while (n-- > 0) {
+		write8(hi);
+		write8(lo);
+	}
+}
+
+/**
+ * @brief Expande pixels indexados de 8 bits pela paleta direto no barramento
+ * @details Não usa buffer intermediário, cada índice é convertido e escrito na janela
+ * aberta por tft_startWrite().
+ *
+ * @param index índices de 8 bits
+ * @param palette paleta de 256 cores RGB565
+ * @param n quantidade de pixels
+ */
+void tft_writeIndexed8(const uint8_t *index, const uint16_t *palette, uint32_t n)
+{
+	if (capture.buf) {
+		while (n-- > 0)
+			capturePixel(palette[*index++]);
+		return;
+	}
+	if (is555 || is9797) {
+		while (n-- > 0)
+			write565(palette[*index++]);
+		return;
+	}
+	while (n-- > 0) {
+		uint16_t color = palette[*index++];
+		write16(color);
+	}
+}
+
+/**
+ * @brief Expande pixels de 4 bits (dois por byte, nibble alto à esquerda) pela paleta
+ * @details Escreve direto na janela aberta por tft_startWrite(), um byte de origem
+ * gera dois pixels sem buffer intermediário.
+ *
+ * @param index pixels de 4 bits empacotados
+ * @param odd 1 se o primeiro pixel é o nibble baixo de index[0]
+ * @param palette paleta de 16 cores RGB565
+ * @param n quantidade de pixels
+ */
+void tft_writeIndexed4(const uint8_t *index, uint8_t odd, const uint16_t *palette, uint32_t n)
+{
+	uint16_t color;
+
+	if (capture.buf) {
+		while (n-- > 0) {
+			capturePixel(palette[odd ? (*index++ & 0x0F) : (*index >> 4)]);
+			odd ^= 1;
+		}
+		return;
+	}
+	if (is555 || is9797) {
+		while (n-- > 0) {
+			write565(palette[odd ? (*index++ & 0x0F) : (*index >> 4)]);
+			odd ^= 1;
+		}
+		return;
+	}
+	if (odd && n > 0) {
+		color = palette[*index++ & 0x0F];
+		write16(color);
+		n--;
+	}
+	while (n >= 2) {
+		uint8_t b = *index++;
+		color = palette[b >> 4];
+		write16(color);
+		color = palette[b & 0x0F];
+		write16(color);
+		n -= 2;
+	}
+	if (n) {
+		color = palette[*index >> 4];
+		write16(color);
+	}
+}
+
+/**
+ * @brief Finaliza a escrita iniciada por tft_startWrite()
+ */
+void tft_endWrite(void)
+{
+	if (capture.buf)
+		return;
+	CS_IDLE;
+	if (!(_lcd_capable & MIPI_DCS_REV1) || ((_lcd_ID == 0x1526) && (rotation & 1)))
+		setAddrWindow(0, 0, width() - 1, height() - 1);
+}
+
+/**
+ * @brief Desvia a escrita em bloco para um buffer em RAM
+ * @details Enquanto instalado, tft_startWrite(), tft_writeColors(), tft_writeColor(),
+ * tft_writeIndexed8() e tft_writeIndexed4() não acessam o barramento: os pixels vão
+ * para buf, que representa a área de w x h pixels a partir de (0, 0) da tela. Pixels
+ * fora dessa área são descartados. Serve para decodificar imagens (tft_image,
+ * tft_jpeg) na RAM; as demais primitivas não são afetadas.
+ *
+ * @param buf w*h pixels RGB565 ou NULL para voltar a escrever no LCD
+ * @param w largura da área capturada
+ * @param h altura da área capturada
+ */
+void tft_setCapture(uint16_t *buf, int16_t w, int16_t h)
+{
+	capture.buf = buf;
+	capture.w = w;
+	capture.h = h;
+	capture.y = capture.y1 = 0;
+	capture.x = capture.x1 = -1;
+}
+
+/****************** Sincronismo com a varredura do painel **********/
+
+/**
+ * @brief Lê a linha que o painel está varrendo (Get Scanline, 0x45)
+ * @details Disponível apenas nos controladores MIPI DCS. A contagem segue a
+ * orientação nativa do painel (retrato) e inclui as linhas do blanking.
+ *
+ * @return linha atual ou 0xFFFF se o controlador não suporta
+ */
+uint16_t tft_getScanline(void)
+{
+	uint8_t hi, lo;
+
+	if (!(_lcd_capable & MIPI_DCS_REV1) || is8347)
+		return 0xFFFF;
+	//Um só comando: byte falso, bits 9..8 e bits 7..0 da linha
+	CS_ACTIVE;
+	WriteCmd(0x45);
+	setReadDir();
+	delay(1);
+	READ_8(hi);
+	READ_8(hi);
+	READ_8(lo);
+	RD_IDLE;
+	CS_IDLE;
+	setWriteDir();
+	return ((hi << 8) | lo) & 0x03FF;
+}
+
+/**
+ * @brief Espera o blanking vertical
+ * @details Usa a borda de subida do pino TE quando TE_PORT/TE_PIN estão definidos
+ * em user_setting.h. Sem o pino, espera a contagem de linhas entrar no blanking
+ * (linha >= HEIGHT) ou voltar ao início, o que o controlador reportar primeiro.
+ */
+void tft_waitVBlank(void)
+{
+	uint32_t start = HAL_GetTick();
+#if defined(TE_PORT) && defined(TE_PIN)
+	while (HAL_GPIO_ReadPin(TE_PORT, TE_PIN) == GPIO_PIN_SET)
+		if (HAL_GetTick() - start > TFT_VSYNC_TIMEOUT) return;
+	while (HAL_GPIO_ReadPin(TE_PORT, TE_PIN) == GPIO_PIN_RESET)
+		if (HAL_GetTick() - start > TFT_VSYNC_TIMEOUT) return;
+#else
+	uint16_t line, last = tft_getScanline();
+	if (last == 0xFFFF)
+		return;
+	while ((line = tft_getScanline()) >= last && line < HEIGHT) {
+		last = line;
+		if (HAL_GetTick() - start > TFT_VSYNC_TIMEOUT) return;
+	}
+#endif
+}
+
+/**
+ * @brief Habilita a escrita sincronizada com a varredura (sem "tearing")
+ * @details Liga a saída TE (0x35, apenas blanking vertical) e faz tft_fillRect(),
+ * tft_fillScreen() e tft_drawRGBBitmap() escreverem em faixas de TFT_VSYNC_BAND
+ * linhas. Cada faixa só começa depois que a varredura passou pelo seu topo e
+ * enquanto ela está a menos de TFT_VSYNC_LEAD linhas à frente, então a
+ * varredura não alcança a escrita mesmo em regiões maiores que o blanking.
+ * Na rotação 0 a escrita persegue a varredura; nas demais, em que a ordem de
+ * escrita não acompanha a varredura, a região espera um único blanking vertical
+ * e é enviada inteira, sem faixas.
+ * Regiões de até TFT_VSYNC_BAND linhas (linhas, texto, pequenos retângulos) são
+ * escritas sem esperar, para não atrasar o desenho comum.
+ *
+ * @param enable 1 habilita, 0 desabilita
+ */
+void tft_setTearingSync(uint8_t enable)
+{
+	uint8_t mode = 0x00;
+
+	if (!(_lcd_capable & MIPI_DCS_REV1) || is8347)
+		enable = 0;
+	if (enable)
+		WriteCmdParamN(0x35, 1, &mode);
+	else if ((_lcd_capable & MIPI_DCS_REV1) && !is8347)
+		WriteCmdParamN(0x34, 0, NULL);
+	vsync_enabled = enable;
+}
+
+/**
+ * @brief Espera o momento seguro para escrever as linhas y..y+h-1 da tela
+ */
+static void vsync_wait(int16_t y, int16_t h)
+{
+	uint32_t start = HAL_GetTick();
+	uint16_t line;
+
+	if (rotation != 0) {
+		tft_waitVBlank();
+		return;
+	}
+	//A varredura já passou pelo topo da faixa e não está tão à frente a ponto
+	//de dar a volta no painel e alcançar a escrita
+	while ((line = tft_getScanline()) != 0xFFFF) {
+		if (line >= y && line < y + TFT_VSYNC_LEAD)
+			return;
+		if (HAL_GetTick() - start > TFT_VSYNC_TIMEOUT)
+			return;
+	}
+}
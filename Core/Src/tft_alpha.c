@@ -0,0 +1,128 @@
+/**
+ ******************************************************************************
+ * @file    tft_alpha.c
+ * @brief   Desenho de imagens RGB565 com canal alfa.
+ ******************************************************************************
+ * @attention
+ *
+ * Cada linha é dividida em trechos; os pixels com alfa 0 não custam nada
+ * no barramento. Os trechos opacos são enviados direto da flash e só os
+ * trechos de borda (alfa parcial) são misturados em line antes do envio.
+ * Pixels opacos isolados entre pixels de borda (menos de ALPHA_OPAQUE_MIN
+ * seguidos) ficam no trecho de borda, copiados sem mistura, porque abrir
+ * outra janela custaria mais que eles.
+ * No modo TFT_ALPHA_READBACK só os trechos de borda são lidos da GRAM com
+ * tft_readGRAM() antes da mistura, o que exige desenho direto no LCD (sem alvo
+ * instalado); com um alvo instalado a mistura é feita contra preto.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_alpha.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define ALPHA_LINE_MAX	((WIDTH > HEIGHT) ? WIDTH : HEIGHT)
+#define ALPHA_OPAQUE_MIN	8	//trecho opaco mais curto que vale uma janela própria
+
+/* Variáveis privadas -------------------------------------------------------*/
+static uint16_t line[ALPHA_LINE_MAX];
+
+/* Funções privadas ---------------------------------------------------------*/
+static inline uint8_t alphaAt(const uint8_t *row, uint8_t abits, int16_t i)
+{
+	if (abits == TFT_ALPHA_A8)
+		return row[i];
+	return ((row[i >> 1] >> ((~i & 1) << 2)) & 0x0F) * 17;
+}
+
+/**
+ * @brief 1 se os ALPHA_OPAQUE_MIN pixels a partir de i são opacos
+ */
+static uint8_t opaqueAhead(const uint8_t *row, uint8_t abits, int16_t i, int16_t end)
+{
+	if (end - i < ALPHA_OPAQUE_MIN)
+		return 0;
+	for (int16_t k = i; k < i + ALPHA_OPAQUE_MIN; k++)
+		if (alphaAt(row, abits, k) != 255)
+			return 0;
+	return 1;
+}
+
+static void writeSpan(int16_t x, int16_t y, const uint16_t *px, int16_t n)
+{
+	const tft_target_t *t = tft_getTarget();
+
+	if (t) {
+		t->writeRect(x, y, n, 1, px);
+		return;
+	}
+	tft_startWrite(x, y, n, 1);
+	tft_writeColors(px, n);
+	tft_endWrite();
+}
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Desenha uma imagem RGB565 com alfa A4 ou A8
+ *
+ * @param x,y canto superior esquerdo (pode estar fora da tela)
+ * @param pixels cores RGB565, w*h
+ * @param alpha canal alfa (TFT_ALPHA_A8: w bytes por linha, TFT_ALPHA_A4: (w+1)/2)
+ * @param abits TFT_ALPHA_A4 ou TFT_ALPHA_A8
+ * @param w,h dimensões em pixels
+ * @param bg cor de fundo da mistura ou TFT_ALPHA_READBACK
+ */
+void tft_drawAlphaBitmap(int16_t x, int16_t y, const uint16_t *pixels, const uint8_t *alpha, uint8_t abits,
+		int16_t w, int16_t h, int32_t bg)
+{
+	int16_t astride = (abits == TFT_ALPHA_A8) ? w : (w + 1) >> 1;
+	int16_t pstride = w;
+	int16_t x0 = 0, y0 = 0;
+	uint8_t readback = bg < 0 && !tft_getTarget();
+
+	if (x < 0) { x0 = -x; w += x; x = 0; }
+	if (y < 0) { y0 = -y; h += y; y = 0; }
+	if (x + w > tft_width()) w = tft_width() - x;
+	if (y + h > tft_height()) h = tft_height() - y;
+	if (w <= 0 || h <= 0)
+		return;
+
+	const uint8_t *arow = alpha + (int32_t)y0 * astride;
+	const uint16_t *prow = pixels + (int32_t)y0 * pstride;
+	int16_t end = x0 + w;
+
+	for (int16_t r = 0; r < h; r++, arow += astride, prow += pstride) {
+		int16_t i = x0;
+		while (i < end) {
+			uint8_t a = alphaAt(arow, abits, i);
+			if (!a) {
+				i++;
+				continue;
+			}
+			int16_t start = i, sx = x + i - x0;
+			if (a == 255) {
+				/* trecho opaco: direto da flash */
+				while (i < end && alphaAt(arow, abits, i) == 255)
+					i++;
+				writeSpan(sx, y + r, prow + start, i - start);
+				continue;
+			}
+			/* trecho de borda: vai até um pixel transparente ou um trecho opaco longo */
+			while (i < end && (a = alphaAt(arow, abits, i)) != 0) {
+				if (a == 255 && opaqueAhead(arow, abits, i, end))
+					break;
+				i++;
+			}
+			int16_t n = i - start;
+			if (readback)
+				tft_readGRAM(sx, y + r, line, n, 1);
+			for (int16_t k = 0; k < n; k++) {
+				a = alphaAt(arow, abits, start + k);
+				uint16_t back = readback ? line[k] : (bg < 0) ? BLACK : (uint16_t)bg;
+				line[k] = (a == 255) ? prow[start + k] : tft_blend565(prow[start + k], back, a);
+			}
+			writeSpan(sx, y + r, line, n);
+		}
+	}
+}
@@ -0,0 +1,158 @@
+/**
+ ******************************************************************************
+ * @file    tft_anim.c
+ * @brief   Reprodução de animações codificadas por diferença entre quadros.
+ ******************************************************************************
+ * @attention
+ *
+ * Cada retângulo alterado é enviado em uma única janela: as repetições
+ * vão por tft_writeColor() e os trechos literais por tft_writeColors()
+ * direto da flash, sem buffer em RAM. Com um alvo instalado
+ * (tft_setTarget()) os mesmos trechos vão, linha a linha, para o
+ * fillRect e o writeRect do alvo. O ritmo vem do SysTick
+ * (HAL_GetTick()); tft_anim_service() deve ser chamada no laço principal.
+ * A animação precisa caber inteira na tela.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_anim.h"
+
+/* Funções privadas ---------------------------------------------------------*/
+/**
+ * @brief Envia ao alvo n pixels a partir da posição pos de um retângulo de largura w
+ * @details O trecho é dividido nas quebras de linha; px NULL é uma repetição de color.
+ */
+static void target_span(const tft_target_t *t, int16_t x, int16_t y, int16_t w, uint32_t pos,
+		const uint16_t *px, uint16_t color, uint32_t n)
+{
+	while (n) {
+		int16_t col = pos % w, row = pos / w;
+		int16_t k = (n < (uint32_t)(w - col)) ? (int16_t)n : w - col;
+		if (px) {
+			t->writeRect(x + col, y + row, k, 1, px);
+			px += k;
+		} else {
+			t->fillRect(x + col, y + row, k, 1, color);
+		}
+		pos += k;
+		n -= k;
+	}
+}
+
+/**
+ * @brief Desenha um retângulo RLE e retorna o ponteiro após seus dados
+ */
+static const uint16_t *draw_rect(const uint16_t *p, int16_t ox, int16_t oy)
+{
+	int16_t x = p[0], y = p[1], w = p[2], h = p[3];
+	uint32_t left = (uint32_t)w * h;
+	const tft_target_t *t = tft_getTarget();
+
+	p += 4;
+	if (!t)
+		tft_startWrite(ox + x, oy + y, w, h);
+	while (left) {
+		uint16_t ctrl = *p++;
+		uint32_t n = (ctrl & ~TFT_ANIM_RUN) + 1;
+		if (n > left)
+			n = left;
+		if (ctrl & TFT_ANIM_RUN) {
+			if (t)
+				target_span(t, ox + x, oy + y, w, (uint32_t)w * h - left, NULL, *p, n);
+			else
+				tft_writeColor(*p, n);
+			p++;
+		} else {
+			if (t)
+				target_span(t, ox + x, oy + y, w, (uint32_t)w * h - left, p, 0, n);
+			else
+				tft_writeColors(p, n);
+			p += (ctrl & ~TFT_ANIM_RUN) + 1;
+		}
+		left -= n;
+	}
+	if (!t)
+		tft_endWrite();
+	return p;
+}
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Prepara uma animação; o primeiro quadro sai na próxima chamada de
+ * tft_anim_step() ou tft_anim_service()
+ *
+ * @param data animação gerada por Tools/anim_encode.c
+ * @param x,y posição na tela
+ * @return 0 ou -1 se o cabeçalho é inválido ou a animação não cabe na tela
+ */
+int8_t tft_anim_init(tft_anim_t *a, const uint16_t *data, int16_t x, int16_t y)
+{
+	a->data = NULL;
+	if (data[0] != TFT_ANIM_MAGIC || data[3] == 0)
+		return -1;
+	if (x < 0 || y < 0 || x + data[1] > tft_width() || y + data[2] > tft_height())
+		return -1;
+	a->data = data;
+	a->pos = data + TFT_ANIM_HEADER;
+	a->loop_pos = NULL;
+	a->x = x;
+	a->y = y;
+	a->frame = 0;
+	a->next_tick = HAL_GetTick();
+	return 0;
+}
+
+/**
+ * @brief Desenha o próximo quadro imediatamente
+ *
+ * @return 1 se um quadro foi desenhado, 0 se a animação terminou
+ */
+uint8_t tft_anim_step(tft_anim_t *a)
+{
+	if (tft_anim_done(a))
+		return 0;
+
+	const uint16_t *p = a->pos;
+	uint16_t n = *p++;
+	while (n--)
+		p = draw_rect(p, a->x, a->y);
+	a->frame++;
+	if (a->frame == 1)
+		a->loop_pos = p;
+	if (a->frame == a->data[3] && (a->data[5] & TFT_ANIM_LOOP) && a->frame > 1) {
+		a->frame = 1;
+		p = a->loop_pos;
+	}
+	a->pos = p;
+	return 1;
+}
+
+/**
+ * @brief Desenha o próximo quadro se já chegou a hora dele
+ * @details Se a aplicação atrasar mais de um quadro, a contagem recomeça do
+ * instante atual em vez de desenhar quadros em rajada.
+ *
+ * @return 1 se um quadro foi desenhado
+ */
+uint8_t tft_anim_service(tft_anim_t *a)
+{
+	uint32_t now = HAL_GetTick();
+
+	if (tft_anim_done(a) || (int32_t)(now - a->next_tick) < 0)
+		return 0;
+	tft_anim_step(a);
+	a->next_tick += a->data[4];
+	if ((int32_t)(now - a->next_tick) >= 0)
+		a->next_tick = now + a->data[4];
+	return 1;
+}
+
+/**
+ * @brief Informa se a animação (sem laço) já mostrou o último quadro
+ */
+uint8_t tft_anim_done(const tft_anim_t *a)
+{
+	return !a->data || a->frame >= a->data[3];
+}
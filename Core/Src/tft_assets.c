@@ -0,0 +1,198 @@
+/**
+ ******************************************************************************
+ * @file    tft_assets.c
+ * @brief   Acesso ao pacote de recursos em flash.
+ ******************************************************************************
+ * @attention
+ *
+ * A busca é binária sobre o índice ordenado por id, O(log n), sem copiar
+ * nada para a RAM: as funções retornam ponteiros para a flash, que os
+ * decodificadores (tft_image, tft_jpeg) e o texto usam diretamente.
+ * Nomes diferentes com o mesmo hash ficam em entradas vizinhas e são
+ * desempatados pelo nome.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_assets.h"
+#include "tft_image.h"
+#include "tft_jpeg.h"
+
+/* Variáveis privadas -------------------------------------------------------*/
+extern const uint8_t _sassets[] __attribute__((weak));	//início do setor ASSETS (linker)
+
+static const tft_assetpack_t *pack;
+
+/* Funções privadas ---------------------------------------------------------*/
+/**
+ * @brief Primeira entrada com id >= key
+ */
+static uint16_t lower_bound(uint32_t key)
+{
+	uint16_t lo = 0, hi = pack->count;
+
+	while (lo < hi) {
+		uint16_t mid = (lo + hi) >> 1;
+		if (pack->index[mid].id < key)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/**
+ * @brief Imagem RGB565 crua, recortada, em uma única janela
+ */
+static void draw_raw(int16_t x, int16_t y, const uint16_t *px, int16_t w, int16_t h)
+{
+	int16_t x0 = 0, y0 = 0, stride = w;
+
+	if (x < 0) { x0 = -x; w += x; x = 0; }
+	if (y < 0) { y0 = -y; h += y; y = 0; }
+	if (x + w > tft_width()) w = tft_width() - x;
+	if (y + h > tft_height()) h = tft_height() - y;
+	if (w <= 0 || h <= 0)
+		return;
+	px += (int32_t)y0 * stride + x0;
+	const tft_target_t *t = tft_getTarget();
+	if (t) {
+		for (int16_t r = 0; r < h; r++, px += stride)
+			t->writeRect(x, y + r, w, 1, px);
+		return;
+	}
+	tft_startWrite(x, y, w, h);
+	for (int16_t r = 0; r < h; r++, px += stride)
+		tft_writeColors(px, w);
+	tft_endWrite();
+}
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Seleciona o pacote de recursos
+ *
+ * @param p pacote na memória ou NULL para o setor ASSETS da flash
+ * @return 0 ou -1 se não há um pacote válido
+ */
+int8_t tft_assets_mount(const void *p)
+{
+	const tft_assetpack_t *pk = p ? p : (const void *)_sassets;
+
+	pack = NULL;
+	if (!pk || pk->magic != TFT_ASSETS_MAGIC || pk->version != TFT_ASSETS_VERSION)
+		return -1;
+	pack = pk;
+	return 0;
+}
+
+/**
+ * @brief Quantidade de recursos no pacote montado
+ */
+uint16_t tft_assets_count(void)
+{
+	return pack ? pack->count : 0;
+}
+
+/**
+ * @brief Hash FNV-1a de 32 bits do nome, o id do recurso
+ */
+uint32_t tft_asset_hash(const char *name)
+{
+	uint32_t h = 2166136261u;
+
+	for (uint8_t i = 0; name[i] && i < TFT_ASSET_NAME - 1; i++) {
+		h ^= (uint8_t)name[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/**
+ * @brief Busca um recurso pelo id
+ *
+ * @return entrada do índice ou NULL
+ */
+const tft_asset_t *tft_asset_find(uint32_t id)
+{
+	if (!pack)
+		return NULL;
+	uint16_t i = lower_bound(id);
+	return (i < pack->count && pack->index[i].id == id) ? &pack->index[i] : NULL;
+}
+
+/**
+ * @brief Busca um recurso pelo nome (até TFT_ASSET_NAME - 1 caracteres)
+ *
+ * @return entrada do índice ou NULL
+ */
+const tft_asset_t *tft_asset_findName(const char *name)
+{
+	uint32_t id = tft_asset_hash(name);
+
+	if (!pack)
+		return NULL;
+	for (uint16_t i = lower_bound(id); i < pack->count && pack->index[i].id == id; i++)
+		if (!strncmp(pack->index[i].name, name, TFT_ASSET_NAME - 1))
+			return &pack->index[i];
+	return NULL;
+}
+
+/**
+ * @brief Ponteiro para os dados do recurso, na flash
+ *
+ * @return dados ou NULL se a é NULL ou não há pacote selecionado
+ */
+const void *tft_asset_data(const tft_asset_t *a)
+{
+	if (!a || !pack)
+		return NULL;
+	return (const uint8_t *)pack + a->offset;
+}
+
+/**
+ * @brief Desenha um recurso de imagem com o decodificador do seu formato
+ *
+ * @param x,y canto superior esquerdo
+ * @return 0 ou -1 se o recurso é NULL, não é uma imagem ou os dados são inválidos
+ */
+int8_t tft_asset_draw(int16_t x, int16_t y, const tft_asset_t *a)
+{
+	const void *d = tft_asset_data(a);
+
+	if (!d)
+		return -1;
+	switch (a->format) {
+	case TFT_ASSET_RGB565:
+		draw_raw(x, y, d, a->w, a->h);
+		return 0;
+	case TFT_ASSET_RLE:
+		return tft_drawRLE(x, y, d);
+	case TFT_ASSET_QOI:
+		return tft_drawQOI(x, y, d);
+	case TFT_ASSET_JPEG:
+		return (tft_drawJPEG(x, y, d, a->size, TFT_JPEG_SCALE_1) == TFT_JPEG_OK) ? 0 : -1;
+	default:
+		return -1;
+	}
+}
+
+/**
+ * @brief Prepara um GFXfont que usa os glifos e bitmaps direto do pacote
+ *
+ * @param font estrutura preenchida (pode ser passada a tft_setFont())
+ * @return 0 ou -1 se o recurso é NULL ou não é uma fonte
+ */
+int8_t tft_asset_font(const tft_asset_t *a, GFXfont *font)
+{
+	const uint8_t *d = tft_asset_data(a);
+
+	if (!d || a->format != TFT_ASSET_FONT || d[1] < d[0])
+		return -1;
+	font->first = d[0];
+	font->last = d[1];
+	font->yAdvance = d[2];
+	font->glyph = (GFXglyph *)(d + 4);
+	font->bitmap = (uint8_t *)(d + 4 + (d[1] - d[0] + 1) * sizeof(GFXglyph));
+	return 0;
+}
@@ -0,0 +1,229 @@
+/**
+ ******************************************************************************
+ * @file    tft_compose.c
+ * @brief   Composição de camadas em RAM (fundos em flash + sobreposições).
+ ******************************************************************************
+ * @attention
+ *
+ * As camadas são desenhadas de baixo para cima (ordem de criação) sobre
+ * preto, linha a linha, nas faixas de tft_pipe_draw(), e cada faixa pronta
+ * é enviada uma vez. A mistura usa alfa de 5 bits sobre os três canais de
+ * uma vez (cor RGB565 espalhada em 32 bits); linhas de camadas RGB565
+ * opacas são apenas copiadas.
+ * Mover, mostrar ou alterar uma camada registra a área antiga e a nova em
+ * tft_damage; tft_compose_update() recompõe só essas áreas, então o fundo
+ * não é reenviado inteiro nem duas vezes.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_compose.h"
+#include "tft_pipe.h"
+#include "tft_damage.h"
+#include "tft_alpha.h"
+
+/* Variáveis privadas -------------------------------------------------------*/
+static tft_layer_t layers[TFT_COMPOSE_LAYERS];
+static uint8_t layer_count;
+
+/* Funções privadas ---------------------------------------------------------*/
+static tft_layer_t *layer_new(uint8_t type, int16_t x, int16_t y, int16_t w, int16_t h, uint8_t alpha)
+{
+	if (layer_count == TFT_COMPOSE_LAYERS)
+		return NULL;
+	tft_layer_t *l = &layers[layer_count++];
+	memset(l, 0, sizeof(*l));
+	l->type = type;
+	l->alpha = alpha;
+	l->visible = 1;
+	l->x = x; l->y = y; l->w = w; l->h = h;
+	l->key = -1;
+	tft_damage_add(x, y, w, h);
+	return l;
+}
+
+/**
+ * @brief Compõe uma linha da tela (sy, colunas sx0..sx0+w-1) em line
+ */
+static void compose_line(uint16_t *line, int16_t sx0, int16_t sy, int16_t w)
+{
+	for (int16_t i = 0; i < w; i++)
+		line[i] = BLACK;
+	for (uint8_t k = 0; k < layer_count; k++) {
+		const tft_layer_t *l = &layers[k];
+		if (!l->visible || l->alpha == 0 || sy < l->y || sy >= l->y + l->h)
+			continue;
+		int16_t c0 = (sx0 > l->x) ? sx0 : l->x;
+		int16_t c1 = (sx0 + w < l->x + l->w) ? sx0 + w : l->x + l->w;
+		if (c0 >= c1)
+			continue;
+		int32_t i = (int32_t)(sy - l->y) * l->w + (c0 - l->x);
+		uint16_t *dst = &line[c0 - sx0];
+		int16_t n = c1 - c0;
+
+		if (l->type == TFT_LAYER_RGB565 && l->alpha == 255) {
+			memcpy(dst, &((const uint16_t *)l->pixels)[i], n * sizeof(uint16_t));
+			continue;
+		}
+		for (; n > 0; n--, i++, dst++) {
+			uint16_t fg;
+			uint8_t a = l->alpha;
+			switch (l->type) {
+			case TFT_LAYER_SOLID:
+				fg = l->color;
+				break;
+			case TFT_LAYER_RGB565:
+				fg = ((const uint16_t *)l->pixels)[i];
+				break;
+			case TFT_LAYER_INDEXED: {
+				uint8_t v = ((const uint8_t *)l->pixels)[i];
+				if (v == l->key)
+					continue;
+				fg = l->palette[v];
+				break;
+			}
+			default:
+				fg = ((const uint16_t *)l->pixels)[i];
+				a = (uint16_t)l->mask[i] * l->alpha / 255;
+				break;
+			}
+			if (a == 255)
+				*dst = fg;
+			else if (a)
+				*dst = tft_blend565(fg, *dst, a);
+		}
+	}
+}
+
+static void compose_band(uint16_t *band, int16_t y, int16_t rows, int16_t w, void *ctx)
+{
+	const tft_rect_t *r = (const tft_rect_t *)ctx;
+
+	for (int16_t row = 0; row < rows; row++)
+		compose_line(band + (int32_t)row * w, r->x, r->y + y + row, w);
+}
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Remove todas as camadas
+ */
+void tft_compose_clear(void)
+{
+	layer_count = 0;
+}
+
+/**
+ * @brief Acrescenta uma camada de cor única
+ *
+ * @return camada criada ou NULL se já há TFT_COMPOSE_LAYERS camadas
+ */
+tft_layer_t *tft_compose_addSolid(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, uint8_t alpha)
+{
+	tft_layer_t *l = layer_new(TFT_LAYER_SOLID, x, y, w, h, alpha);
+	if (l)
+		l->color = color;
+	return l;
+}
+
+/**
+ * @brief Acrescenta uma imagem RGB565 (por exemplo um fundo de tela em flash)
+ */
+tft_layer_t *tft_compose_addImage(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels, uint8_t alpha)
+{
+	tft_layer_t *l = layer_new(TFT_LAYER_RGB565, x, y, w, h, alpha);
+	if (l)
+		l->pixels = pixels;
+	return l;
+}
+
+/**
+ * @brief Acrescenta uma imagem indexada de 8 bits
+ *
+ * @param key índice transparente ou -1
+ */
+tft_layer_t *tft_compose_addIndexed(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pixels,
+		const uint16_t *palette, int16_t key, uint8_t alpha)
+{
+	tft_layer_t *l = layer_new(TFT_LAYER_INDEXED, x, y, w, h, alpha);
+	if (l) {
+		l->pixels = pixels;
+		l->palette = palette;
+		l->key = key;
+	}
+	return l;
+}
+
+/**
+ * @brief Acrescenta uma imagem RGB565 com alfa de 8 bits por pixel
+ */
+tft_layer_t *tft_compose_addAlpha(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels, const uint8_t *mask)
+{
+	tft_layer_t *l = layer_new(TFT_LAYER_RGB565A8, x, y, w, h, 255);
+	if (l) {
+		l->pixels = pixels;
+		l->mask = mask;
+	}
+	return l;
+}
+
+/**
+ * @brief Move uma camada; a área antiga e a nova serão recompostas no próximo update
+ */
+void tft_compose_move(tft_layer_t *l, int16_t x, int16_t y)
+{
+	if (l->visible)
+		tft_damage_add(l->x, l->y, l->w, l->h);
+	l->x = x;
+	l->y = y;
+	if (l->visible)
+		tft_damage_add(x, y, l->w, l->h);
+}
+
+/**
+ * @brief Mostra ou esconde uma camada
+ */
+void tft_compose_show(tft_layer_t *l, uint8_t visible)
+{
+	if (l->visible != visible)
+		tft_damage_add(l->x, l->y, l->w, l->h);
+	l->visible = visible;
+}
+
+/**
+ * @brief Informa que o conteúdo da camada mudou (cor, alfa, pixels)
+ */
+void tft_compose_touch(tft_layer_t *l)
+{
+	tft_damage_add(l->x, l->y, l->w, l->h);
+}
+
+/**
+ * @brief Compõe e envia uma região da tela
+ */
+void tft_compose_draw(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	tft_rect_t r;
+
+	if (x < 0) { w += x; x = 0; }
+	if (y < 0) { h += y; y = 0; }
+	if (x + w > tft_width()) w = tft_width() - x;
+	if (y + h > tft_height()) h = tft_height() - y;
+	if (w <= 0 || h <= 0)
+		return;
+	r.x = x; r.y = y; r.w = w; r.h = h;
+	tft_pipe_draw(x, y, w, h, compose_band, &r);
+}
+
+/**
+ * @brief Recompõe apenas as áreas alteradas desde o último update
+ * @details As áreas ficam na lista de tft_damage, compartilhada com a aplicação.
+ */
+void tft_compose_update(void)
+{
+	tft_rect_t rects[TFT_DAMAGE_MAX];
+	uint8_t n = tft_damage_get(rects, TFT_DAMAGE_MAX);
+
+	for (uint8_t i = 0; i < n; i++)
+		tft_compose_draw(rects[i].x, rects[i].y, rects[i].w, rects[i].h);
+}
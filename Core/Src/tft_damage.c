@@ -0,0 +1,189 @@
+/**
+ ******************************************************************************
+ * @file    tft_damage.c
+ * @brief   Controle das regiões alteradas da tela (dirty rectangles).
+ ******************************************************************************
+ * @attention
+ *
+ * O custo de repintar um retângulo é estimado como a sua área mais o custo
+ * fixo de abrir uma janela no LCD (TFT_DAMAGE_WINDOW_COST pixels). Dois
+ * retângulos são unidos sempre que o retângulo envolvente custa menos que
+ * os dois separados; isso cobre sobreposição, contenção e vizinhança.
+ * Com a lista cheia, o novo retângulo é unido ao que gera o menor aumento
+ * de custo, portanto a lista nunca passa de TFT_DAMAGE_MAX entradas.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_damage.h"
+
+/* Variáveis privadas -------------------------------------------------------*/
+static tft_rect_t damage[TFT_DAMAGE_MAX];
+static uint8_t damage_count;
+static const tft_target_t *damage_inner;
+
+/* Funções privadas ---------------------------------------------------------*/
+static int32_t rect_cost(const tft_rect_t *r)
+{
+	return (int32_t)r->w * r->h + TFT_DAMAGE_WINDOW_COST;
+}
+
+static void rect_union(const tft_rect_t *a, const tft_rect_t *b, tft_rect_t *u)
+{
+	int16_t x0 = (a->x < b->x) ? a->x : b->x;
+	int16_t y0 = (a->y < b->y) ? a->y : b->y;
+	int16_t x1 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+	int16_t y1 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+	u->x = x0;
+	u->y = y0;
+	u->w = x1 - x0;
+	u->h = y1 - y0;
+}
+
+static void damage_remove(uint8_t i)
+{
+	damage[i] = damage[--damage_count];
+}
+
+static void damage_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+	tft_damage_add(x, y, w, h);
+	if (damage_inner)
+		damage_inner->fillRect(x, y, w, h, color);
+}
+
+static void damage_writeRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels)
+{
+	tft_damage_add(x, y, w, h);
+	if (damage_inner)
+		damage_inner->writeRect(x, y, w, h, pixels);
+}
+
+static const tft_target_t damage_target = { damage_fillRect, damage_writeRect };
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Descarta todas as regiões registradas
+ */
+void tft_damage_reset(void)
+{
+	damage_count = 0;
+}
+
+/**
+ * @brief Registra uma região alterada
+ * @details A região é recortada pelos limites da tela e unida às já registradas
+ * enquanto a união for mais barata que repintar as partes separadas.
+ *
+ * @param x coluna do canto superior esquerdo
+ * @param y linha do canto superior esquerdo
+ * @param w largura
+ * @param h altura
+ */
+void tft_damage_add(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	tft_rect_t r, u;
+	uint8_t merged;
+
+	if (x < 0) { w += x; x = 0; }
+	if (y < 0) { h += y; y = 0; }
+	if (x + w > tft_width()) w = tft_width() - x;
+	if (y + h > tft_height()) h = tft_height() - y;
+	if (w <= 0 || h <= 0)
+		return;
+	r.x = x; r.y = y; r.w = w; r.h = h;
+
+	do {
+		merged = 0;
+		for (uint8_t i = 0; i < damage_count; i++) {
+			rect_union(&damage[i], &r, &u);
+			if (rect_cost(&u) <= rect_cost(&damage[i]) + rect_cost(&r)) {
+				r = u;
+				damage_remove(i);
+				merged = 1;
+				break;
+			}
+		}
+	} while (merged);
+
+	if (damage_count == TFT_DAMAGE_MAX) {
+		//Lista cheia: une com o retângulo que gera o menor aumento de custo
+		int32_t best = 0x7FFFFFFF;
+		uint8_t best_i = 0;
+		for (uint8_t i = 0; i < damage_count; i++) {
+			rect_union(&damage[i], &r, &u);
+			int32_t delta = rect_cost(&u) - rect_cost(&damage[i]);
+			if (delta < best) {
+				best = delta;
+				best_i = i;
+			}
+		}
+		rect_union(&damage[best_i], &r, &u);
+		damage_remove(best_i);
+		tft_damage_add(u.x, u.y, u.w, u.h);
+		return;
+	}
+	damage[damage_count++] = r;
+}
+
+/**
+ * @brief Quantidade de regiões registradas
+ */
+uint8_t tft_damage_count(void)
+{
+	return damage_count;
+}
+
+/**
+ * @brief Entrega as regiões a repintar e esvazia a lista
+ *
+ * @param rects vetor que recebe os retângulos
+ * @param max tamanho do vetor
+ * @return quantidade de retângulos copiados
+ */
+uint8_t tft_damage_get(tft_rect_t *rects, uint8_t max)
+{
+	uint8_t n = (damage_count < max) ? damage_count : max;
+
+	memcpy(rects, damage, n * sizeof(tft_rect_t));
+	damage_count = 0;
+	return n;
+}
+
+/**
+ * @brief Chama a função de repintura para cada região registrada e esvazia a lista
+ *
+ * @param repaint função da aplicação que redesenha uma região
+ */
+void tft_damage_flush(void (*repaint)(int16_t x, int16_t y, int16_t w, int16_t h))
+{
+	tft_rect_t rects[TFT_DAMAGE_MAX];
+	uint8_t n = tft_damage_get(rects, TFT_DAMAGE_MAX);
+
+	for (uint8_t i = 0; i < n; i++)
+		repaint(rects[i].x, rects[i].y, rects[i].w, rects[i].h);
+}
+
+/**
+ * @brief Registra automaticamente a área tocada pelas primitivas de desenho
+ * @details Instala um alvo de desenho que registra cada retângulo desenhado e
+ * o repassa para o alvo interno (por exemplo um canvas). Com inner NULL nada é
+ * desenhado, apenas a área que o código de desenho tocaria é registrada.
+ *
+ * @param inner alvo que recebe o desenho ou NULL
+ */
+void tft_damage_begin(const tft_target_t *inner)
+{
+	damage_inner = inner;
+	tft_setTarget(&damage_target);
+}
+
+/**
+ * @brief Encerra o registro automático e reinstala o alvo interno
+ */
+void tft_damage_end(void)
+{
+	if (tft_getTarget() == &damage_target)
+		tft_setTarget(damage_inner);
+}
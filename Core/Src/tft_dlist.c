@@ -0,0 +1,329 @@
+/**
+ ******************************************************************************
+ * @file    tft_dlist.c
+ * @brief   Lista de comandos de desenho por quadro (display list).
+ ******************************************************************************
+ * @attention
+ *
+ * A gravação é feita por um alvo de desenho (tft_setTarget): círculos e
+ * triângulos preenchidos são gravados inteiros e as demais primitivas
+ * (linhas, texto, pixels) chegam como retângulos já recortados.
+ * Antes da execução a lista passa por duas etapas:
+ *  - um comando cuja área fica toda sob a parte certamente opaca de um
+ *    comando posterior é descartado (o mesmo vale para comandos repetidos);
+ *  - retângulos da mesma cor que formam um retângulo exato são unidos,
+ *    mesmo fora de ordem, desde que nenhum comando intermediário toque a
+ *    área movida; pixels de texto viram faixas horizontais assim.
+ * Imagens (tft_drawRGBBitmap) não são gravadas: a lista pendente é
+ * executada e os pixels seguem direto, preservando a ordem de desenho.
+ * Com a lista cheia o lote atual é otimizado e executado e a gravação
+ * continua no lote seguinte.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_dlist.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define DL_NONE		0
+#define DL_RECT		1
+#define DL_CIRCLE	2
+#define DL_TRIANGLE	3
+
+#define DL_MERGE_LOOKBACK	8	//comandos anteriores examinados na união
+
+/* Tipos --------------------------------------------------------------------*/
+typedef struct {
+	uint8_t  op;
+	uint16_t color;
+	int16_t  p[6];		//retângulo: x,y,w,h; círculo: x0,y0,r; triângulo: 3 vértices
+} dl_cmd_t;
+
+/* Variáveis privadas -------------------------------------------------------*/
+static dl_cmd_t dl[TFT_DLIST_MAX];
+static uint16_t dl_count;
+static const tft_target_t *dl_prev;
+static uint16_t dl_recorded, dl_executed;
+
+static void dl_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+static void dl_writeRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels);
+static void dl_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+static void dl_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+
+static const tft_target_t dl_target = { dl_fillRect, dl_writeRect, dl_fillCircle, dl_fillTriangle };
+
+/* Funções privadas ---------------------------------------------------------*/
+
+/**
+ * @brief Retângulo envolvente do comando, recortado pela tela
+ */
+static void dl_bounds(const dl_cmd_t *c, tft_rect_t *r)
+{
+	int16_t x0, y0, x1, y1;
+
+	switch (c->op) {
+	case DL_RECT:
+		x0 = c->p[0]; y0 = c->p[1];
+		x1 = x0 + c->p[2] - 1; y1 = y0 + c->p[3] - 1;
+		break;
+	case DL_CIRCLE:
+		x0 = c->p[0] - c->p[2]; y0 = c->p[1] - c->p[2];
+		x1 = c->p[0] + c->p[2]; y1 = c->p[1] + c->p[2];
+		break;
+	default:
+		x0 = x1 = c->p[0];
+		y0 = y1 = c->p[1];
+		for (uint8_t i = 2; i < 6; i += 2) {
+			if (c->p[i] < x0) x0 = c->p[i];
+			if (c->p[i] > x1) x1 = c->p[i];
+			if (c->p[i + 1] < y0) y0 = c->p[i + 1];
+			if (c->p[i + 1] > y1) y1 = c->p[i + 1];
+		}
+		break;
+	}
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 >= tft_width()) x1 = tft_width() - 1;
+	if (y1 >= tft_height()) y1 = tft_height() - 1;
+	r->x = x0; r->y = y0;
+	r->w = x1 - x0 + 1; r->h = y1 - y0 + 1;
+}
+
+/**
+ * @brief Parte do comando que certamente fica opaca
+ * @details Retângulo: ele mesmo. Círculo: quadrado inscrito com uma margem de
+ * um pixel. Triângulo: nenhuma (retorna 0).
+ */
+static uint8_t dl_cover(const dl_cmd_t *c, tft_rect_t *r)
+{
+	if (c->op == DL_RECT) {
+		r->x = c->p[0]; r->y = c->p[1];
+		r->w = c->p[2]; r->h = c->p[3];
+		return 1;
+	}
+	if (c->op == DL_CIRCLE) {
+		int16_t k = ((int32_t)c->p[2] * 181 >> 8) - 1;		//r/sqrt(2)
+		if (k < 0)
+			return 0;
+		r->x = c->p[0] - k; r->y = c->p[1] - k;
+		r->w = r->h = 2 * k + 1;
+		return 1;
+	}
+	return 0;
+}
+
+static uint8_t rect_contains(const tft_rect_t *outer, const tft_rect_t *inner)
+{
+	return inner->x >= outer->x && inner->y >= outer->y
+			&& inner->x + inner->w <= outer->x + outer->w
+			&& inner->y + inner->h <= outer->y + outer->h;
+}
+
+static uint8_t rect_intersects(const tft_rect_t *a, const tft_rect_t *b)
+{
+	return a->x < b->x + b->w && b->x < a->x + a->w
+			&& a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+/**
+ * @brief Une dois retângulos quando o resultado é exatamente um retângulo
+ *
+ * @return 1 se a união foi feita em b
+ */
+static uint8_t dl_join(const dl_cmd_t *a, dl_cmd_t *b)
+{
+	int16_t lo, hi;
+
+	if (a->p[0] == b->p[0] && a->p[2] == b->p[2]) {
+		//mesma faixa de colunas, verticalmente vizinhos ou sobrepostos
+		if (a->p[1] > b->p[1] + b->p[3] || b->p[1] > a->p[1] + a->p[3])
+			return 0;
+		lo = (a->p[1] < b->p[1]) ? a->p[1] : b->p[1];
+		hi = (a->p[1] + a->p[3] > b->p[1] + b->p[3]) ? a->p[1] + a->p[3] : b->p[1] + b->p[3];
+		b->p[1] = lo;
+		b->p[3] = hi - lo;
+		return 1;
+	}
+	if (a->p[1] == b->p[1] && a->p[3] == b->p[3]) {
+		//mesma faixa de linhas, horizontalmente vizinhos ou sobrepostos
+		if (a->p[0] > b->p[0] + b->p[2] || b->p[0] > a->p[0] + a->p[2])
+			return 0;
+		lo = (a->p[0] < b->p[0]) ? a->p[0] : b->p[0];
+		hi = (a->p[0] + a->p[2] > b->p[0] + b->p[2]) ? a->p[0] + a->p[2] : b->p[0] + b->p[2];
+		b->p[0] = lo;
+		b->p[2] = hi - lo;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Descarta comandos encobertos por comandos posteriores
+ */
+static void dl_cull(void)
+{
+	tft_rect_t box, cover;
+
+	for (uint16_t i = 0; i < dl_count; i++) {
+		dl_bounds(&dl[i], &box);
+		for (uint16_t j = i + 1; j < dl_count; j++) {
+			if (dl[j].op == DL_NONE)
+				continue;
+			if ((dl[j].op == dl[i].op && !memcmp(dl[j].p, dl[i].p, sizeof(dl[i].p)))
+					|| (dl_cover(&dl[j], &cover) && rect_contains(&cover, &box))) {
+				dl[i].op = DL_NONE;
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Une retângulos da mesma cor, trazendo o anterior para a posição do atual
+ */
+static void dl_merge(void)
+{
+	tft_rect_t moved, other;
+
+	for (uint16_t i = 1; i < dl_count; i++) {
+		if (dl[i].op != DL_RECT)
+			continue;
+		uint16_t seen = 0;
+		for (int16_t k = i - 1; k >= 0 && seen < DL_MERGE_LOOKBACK; k--) {
+			if (dl[k].op == DL_NONE)
+				continue;
+			seen++;
+			if (dl[k].op != DL_RECT || dl[k].color != dl[i].color)
+				continue;
+			//dl[k] passa a ser desenhado depois dos comandos entre k e i
+			uint8_t blocked = 0;
+			dl_bounds(&dl[k], &moved);
+			for (uint16_t m = k + 1; m < i && !blocked; m++) {
+				if (dl[m].op == DL_NONE)
+					continue;
+				dl_bounds(&dl[m], &other);
+				blocked = rect_intersects(&moved, &other);
+			}
+			if (!blocked && dl_join(&dl[k], &dl[i])) {
+				dl[k].op = DL_NONE;
+				k = i;		//o retângulo cresceu, recomeça a busca
+				seen = 0;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Otimiza e executa o lote gravado no alvo anterior (LCD ou canvas)
+ */
+static void dl_run(void)
+{
+	dl_cull();
+	dl_merge();
+	tft_setTarget(dl_prev);
+	for (uint16_t i = 0; i < dl_count; i++) {
+		dl_cmd_t *c = &dl[i];
+		switch (c->op) {
+		case DL_RECT:
+			tft_fillRect(c->p[0], c->p[1], c->p[2], c->p[3], c->color);
+			break;
+		case DL_CIRCLE:
+			tft_fillCircle(c->p[0], c->p[1], c->p[2], c->color);
+			break;
+		case DL_TRIANGLE:
+			tft_fillTriangle(c->p[0], c->p[1], c->p[2], c->p[3], c->p[4], c->p[5], c->color);
+			break;
+		default:
+			continue;
+		}
+		dl_executed++;
+	}
+	tft_setTarget(&dl_target);
+	dl_count = 0;
+}
+
+static dl_cmd_t *dl_new(uint8_t op, uint16_t color)
+{
+	if (dl_count == TFT_DLIST_MAX)
+		dl_run();
+	dl_cmd_t *c = &dl[dl_count++];
+	c->op = op;
+	c->color = color;
+	memset(c->p, 0, sizeof(c->p));
+	dl_recorded++;
+	return c;
+}
+
+static void dl_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+	dl_cmd_t *c = dl_new(DL_RECT, color);
+	c->p[0] = x; c->p[1] = y; c->p[2] = w; c->p[3] = h;
+}
+
+static void dl_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+	dl_cmd_t *c = dl_new(DL_CIRCLE, color);
+	c->p[0] = x0; c->p[1] = y0; c->p[2] = r;
+}
+
+static void dl_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+{
+	dl_cmd_t *c = dl_new(DL_TRIANGLE, color);
+	c->p[0] = x0; c->p[1] = y0; c->p[2] = x1;
+	c->p[3] = y1; c->p[4] = x2; c->p[5] = y2;
+}
+
+static void dl_writeRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels)
+{
+	//Os pixels podem estar em um buffer temporário: executa o que está pendente
+	//e envia a imagem imediatamente
+	dl_run();
+	if (dl_prev) {
+		dl_prev->writeRect(x, y, w, h, pixels);
+	} else {
+		tft_startWrite(x, y, w, h);
+		tft_writeColors(pixels, (uint32_t)w * h);
+		tft_endWrite();
+	}
+}
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Inicia a gravação de um quadro
+ * @details As primitivas passam a ser gravadas até tft_endFrame(). O alvo ativo
+ * (LCD ou canvas) é guardado e recebe o quadro otimizado.
+ */
+void tft_beginFrame(void)
+{
+	if (tft_getTarget() == &dl_target)
+		return;
+	dl_prev = tft_getTarget();
+	dl_count = 0;
+	dl_recorded = 0;
+	dl_executed = 0;
+	tft_setTarget(&dl_target);
+}
+
+/**
+ * @brief Otimiza e executa o quadro gravado e volta ao alvo anterior
+ */
+void tft_endFrame(void)
+{
+	if (tft_getTarget() != &dl_target)
+		return;
+	dl_run();
+	tft_setTarget(dl_prev);
+}
+
+/**
+ * @brief Comandos gravados e efetivamente executados no último quadro
+ *
+ * @param recorded recebe a quantidade gravada (pode ser NULL)
+ * @param executed recebe a quantidade executada (pode ser NULL)
+ */
+void tft_frameStats(uint16_t *recorded, uint16_t *executed)
+{
+	if (recorded) *recorded = dl_recorded;
+	if (executed) *executed = dl_executed;
+}
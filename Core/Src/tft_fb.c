@@ -0,0 +1,439 @@
+/**
+ ******************************************************************************
+ * @file    tft_fb.c
+ * @brief   Canvas em RAM (framebuffer indexado) para o driver tft.
+ ******************************************************************************
+ * @attention
+ *
+ * O canvas é instalado como alvo de desenho (tft_setTarget), portanto
+ * tft_fillRect, tft_drawPixel, tft_drawRGBBitmap e todas as funções que as
+ * usam (círculos, triângulos, texto...) escrevem no buffer em vez do LCD.
+ * No canvas de 8 bits cada linha guarda o intervalo de colunas alterado; no
+ * flush as linhas sujas vizinhas são agrupadas em uma única janela quando os
+ * pixels extras custam menos que abrir uma nova janela.
+ * No canvas de 4 bits a tela é dividida em blocos de TFT_FB4_TILE pixels e
+ * apenas os blocos alterados são enviados.
+ * Preenchimentos e imagens recebem cores RGB565, convertidas para o índice
+ * da paleta mais próximo; o último par cor/índice fica guardado, então um
+ * retângulo ou uma linha de texto custa uma única busca.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_fb.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define FB_MAX_LINES	((WIDTH > HEIGHT) ? WIDTH : HEIGHT)
+#define FB_WINDOW_COST	12		//custo aproximado de um setAddrWindow, em pixels
+
+#if defined(TFT_USE_FB8)
+
+/* Variáveis privadas -------------------------------------------------------*/
+static uint8_t fb8[(uint32_t)WIDTH * HEIGHT];
+static uint16_t fb8_palette[256];
+static int16_t fb8_w, fb8_h;
+static int16_t fb8_x0[FB_MAX_LINES], fb8_x1[FB_MAX_LINES];	//x0 > x1: linha limpa
+static uint8_t fb8_last_index;
+static uint16_t fb8_last_color;
+
+/* Funções privadas ---------------------------------------------------------*/
+static void fb8_dirty(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	int16_t x1 = x + w - 1;
+	while (h-- > 0) {
+		if (x < fb8_x0[y]) fb8_x0[y] = x;
+		if (x1 > fb8_x1[y]) fb8_x1[y] = x1;
+		y++;
+	}
+}
+
+/**
+ * @brief Procura o índice da paleta mais próximo de uma cor RGB565
+ * @details Guarda o último resultado, porque imagens costumam repetir cores
+ * vizinhas e as primitivas repetem a mesma cor em vários retângulos.
+ */
+static uint8_t fb8_nearest(uint16_t color)
+{
+	uint32_t best = 0xFFFFFFFF;
+	uint8_t index = 0;
+
+	if (color == fb8_last_color)
+		return fb8_last_index;
+	for (uint16_t i = 0; i < 256; i++) {
+		uint16_t c = fb8_palette[i];
+		int32_t dr = (int32_t)(c >> 11) - (color >> 11);
+		int32_t dg = (int32_t)((c >> 5) & 0x3F) - ((color >> 5) & 0x3F);
+		int32_t db = (int32_t)(c & 0x1F) - (color & 0x1F);
+		uint32_t d = 4 * dr * dr + dg * dg + 4 * db * db;
+		if (d < best) {
+			best = d;
+			index = i;
+			if (d == 0) break;
+		}
+	}
+	fb8_last_color = color;
+	fb8_last_index = index;
+	return index;
+}
+
+static void fb8_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+	uint8_t *p = &fb8[(uint32_t)y * fb8_w + x];
+	uint8_t index;
+
+	if (x + w > fb8_w || y + h > fb8_h)
+		return;
+	index = fb8_nearest(color);
+	fb8_dirty(x, y, w, h);
+	for (int16_t row = 0; row < h; row++) {
+		memset(p, index, w);
+		p += fb8_w;
+	}
+}
+
+static void fb8_writeRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels)
+{
+	uint8_t *p = &fb8[(uint32_t)y * fb8_w + x];
+
+	if (x + w > fb8_w || y + h > fb8_h)
+		return;
+	fb8_dirty(x, y, w, h);
+	for (int16_t row = 0; row < h; row++) {
+		for (int16_t col = 0; col < w; col++)
+			p[col] = fb8_nearest(*pixels++);
+		p += fb8_w;
+	}
+}
+
+static const tft_target_t fb8_target = { fb8_fillRect, fb8_writeRect };
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Ativa o canvas de 8 bits como alvo de desenho
+ * @details As dimensões seguem a rotação atual da tela. O conteúdo do buffer é
+ * mantido, mas nenhuma linha é marcada como suja. Na primeira chamada a paleta
+ * é iniciada com a distribuição RGB 3-3-2 (índice RRRGGGBB).
+ */
+void tft_fb8_begin(void)
+{
+	static uint8_t palette_ready = 0;
+
+	if (!palette_ready) {
+		for (uint16_t i = 0; i < 256; i++)
+			fb8_palette[i] = tft_color565(((i >> 5) & 7) * 255 / 7,
+					((i >> 2) & 7) * 255 / 7, (i & 3) * 255 / 3);
+		fb8_last_color = fb8_palette[0];
+		fb8_last_index = 0;
+		palette_ready = 1;
+	}
+	fb8_w = tft_width();
+	fb8_h = tft_height();
+	for (int16_t y = 0; y < FB_MAX_LINES; y++) {
+		fb8_x0[y] = fb8_w;
+		fb8_x1[y] = -1;
+	}
+	tft_setTarget(&fb8_target);
+}
+
+/**
+ * @brief Desativa o canvas, as primitivas voltam a desenhar direto no LCD
+ */
+void tft_fb8_end(void)
+{
+	if (tft_getTarget() == &fb8_target)
+		tft_setTarget(NULL);
+}
+
+/**
+ * @brief Acesso direto ao buffer (linha a linha, tft_width() bytes por linha)
+ * @details Quem escrever direto no buffer deve chamar tft_fb8_markDirty().
+ */
+uint8_t *tft_fb8_buffer(void)
+{
+	return fb8;
+}
+
+/**
+ * @brief Altera entradas da paleta
+ * @details Toda a tela é marcada como suja, o próximo flush reenvia o canvas
+ * inteiro com as novas cores (animação de paleta sem redesenhar nada).
+ *
+ * @param colors cores RGB565
+ * @param first primeiro índice a alterar
+ * @param n quantidade de entradas
+ */
+void tft_fb8_setPalette(const uint16_t *colors, uint16_t first, uint16_t n)
+{
+	while (n-- > 0 && first < 256)
+		fb8_palette[first++] = *colors++;
+	fb8_last_color = fb8_palette[0];
+	fb8_last_index = 0;
+	fb8_dirty(0, 0, fb8_w, fb8_h);
+}
+
+/**
+ * @brief Marca uma região do canvas para ser enviada no próximo flush
+ */
+void tft_fb8_markDirty(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (x < 0) { w += x; x = 0; }
+	if (y < 0) { h += y; y = 0; }
+	if (x + w > fb8_w) w = fb8_w - x;
+	if (y + h > fb8_h) h = fb8_h - y;
+	if (w > 0 && h > 0)
+		fb8_dirty(x, y, w, h);
+}
+
+/**
+ * @brief Envia ao LCD apenas as regiões alteradas, expandindo os índices pela paleta
+ * @details Linhas sujas consecutivas formam uma janela só enquanto as colunas extras
+ * custarem menos que abrir uma nova janela (FB_WINDOW_COST pixels por linha).
+ */
+void tft_fb8_flush(void)
+{
+	int16_t y = 0;
+
+	while (y < fb8_h) {
+		if (fb8_x0[y] > fb8_x1[y]) {
+			y++;
+			continue;
+		}
+		int16_t y0 = y, gx0 = fb8_x0[y], gx1 = fb8_x1[y];
+		int32_t used = gx1 - gx0 + 1;
+		for (y++; y < fb8_h && fb8_x0[y] <= fb8_x1[y]; y++) {
+			int16_t nx0 = (fb8_x0[y] < gx0) ? fb8_x0[y] : gx0;
+			int16_t nx1 = (fb8_x1[y] > gx1) ? fb8_x1[y] : gx1;
+			int32_t rows = y - y0 + 1;
+			int32_t waste = (int32_t)(nx1 - nx0 + 1) * rows - (used + fb8_x1[y] - fb8_x0[y] + 1);
+			if (waste > FB_WINDOW_COST * (rows - 1))
+				break;
+			gx0 = nx0;
+			gx1 = nx1;
+			used += fb8_x1[y] - fb8_x0[y] + 1;
+		}
+		int16_t w = gx1 - gx0 + 1;
+		tft_startWrite(gx0, y0, w, y - y0);
+		for (int16_t row = y0; row < y; row++) {
+			tft_writeIndexed8(&fb8[(uint32_t)row * fb8_w + gx0], fb8_palette, w);
+			fb8_x0[row] = fb8_w;
+			fb8_x1[row] = -1;
+		}
+		tft_endWrite();
+	}
+}
+
+#endif /* TFT_USE_FB8 */
+
+#if defined(TFT_USE_FB4)
+
+/* Contantes e macros -------------------------------------------------------*/
+#define FB4_TILES	(((WIDTH + TFT_FB4_TILE - 1) / TFT_FB4_TILE) * ((HEIGHT + TFT_FB4_TILE - 1) / TFT_FB4_TILE))
+
+/* Variáveis privadas -------------------------------------------------------*/
+static uint8_t fb4[((uint32_t)WIDTH + 1) / 2 * HEIGHT];
+static uint16_t fb4_palette[16];
+static int16_t fb4_w, fb4_h, fb4_stride, fb4_tiles_x, fb4_tiles_y;
+static uint8_t fb4_dirty_map[(FB4_TILES + 7) / 8];
+static uint8_t fb4_last_index;
+static uint16_t fb4_last_color;
+
+/* Funções privadas ---------------------------------------------------------*/
+static void fb4_dirty(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	int16_t tx0 = x / TFT_FB4_TILE, tx1 = (x + w - 1) / TFT_FB4_TILE;
+	int16_t ty0 = y / TFT_FB4_TILE, ty1 = (y + h - 1) / TFT_FB4_TILE;
+
+	for (int16_t ty = ty0; ty <= ty1; ty++)
+		for (int16_t tx = tx0; tx <= tx1; tx++) {
+			uint16_t t = ty * fb4_tiles_x + tx;
+			fb4_dirty_map[t >> 3] |= 1 << (t & 7);
+		}
+}
+
+/**
+ * @brief Procura o índice da paleta mais próximo de uma cor RGB565, com o mesmo cache de fb8_nearest()
+ */
+static uint8_t fb4_nearest(uint16_t color)
+{
+	uint32_t best = 0xFFFFFFFF;
+	uint8_t index = 0;
+
+	if (color == fb4_last_color)
+		return fb4_last_index;
+	for (uint8_t i = 0; i < 16; i++) {
+		uint16_t c = fb4_palette[i];
+		int32_t dr = (int32_t)(c >> 11) - (color >> 11);
+		int32_t dg = (int32_t)((c >> 5) & 0x3F) - ((color >> 5) & 0x3F);
+		int32_t db = (int32_t)(c & 0x1F) - (color & 0x1F);
+		uint32_t d = 4 * dr * dr + dg * dg + 4 * db * db;
+		if (d < best) {
+			best = d;
+			index = i;
+			if (d == 0) break;
+		}
+	}
+	fb4_last_color = color;
+	fb4_last_index = index;
+	return index;
+}
+
+static void fb4_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+	uint8_t c;
+
+	if (x + w > fb4_w || y + h > fb4_h)
+		return;
+	c = fb4_nearest(color);
+	fb4_dirty(x, y, w, h);
+	for (int16_t row = y; row < y + h; row++) {
+		uint8_t *p = &fb4[(uint32_t)row * fb4_stride + (x >> 1)];
+		int16_t n = w;
+		if (x & 1) {
+			*p = (*p & 0xF0) | c;
+			p++;
+			n--;
+		}
+		memset(p, c | (c << 4), n >> 1);
+		if (n & 1) {
+			p += n >> 1;
+			*p = (*p & 0x0F) | (c << 4);
+		}
+	}
+}
+
+static void fb4_writeRect(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels)
+{
+	if (x + w > fb4_w || y + h > fb4_h)
+		return;
+	fb4_dirty(x, y, w, h);
+	for (int16_t row = y; row < y + h; row++) {
+		uint8_t *p = &fb4[(uint32_t)row * fb4_stride];
+		for (int16_t col = x; col < x + w; col++) {
+			uint8_t c = fb4_nearest(*pixels++);
+			if (col & 1)
+				p[col >> 1] = (p[col >> 1] & 0xF0) | c;
+			else
+				p[col >> 1] = (p[col >> 1] & 0x0F) | (c << 4);
+		}
+	}
+}
+
+static const tft_target_t fb4_target = { fb4_fillRect, fb4_writeRect };
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Ativa o canvas de 4 bits como alvo de desenho
+ * @details As dimensões seguem a rotação atual da tela. Na primeira chamada a
+ * paleta é iniciada com as 16 cores clássicas do padrão VGA.
+ */
+void tft_fb4_begin(void)
+{
+	static uint8_t palette_ready = 0;
+	static const uint8_t vga[16][3] = {
+		{0x00,0x00,0x00}, {0x00,0x00,0xAA}, {0x00,0xAA,0x00}, {0x00,0xAA,0xAA},
+		{0xAA,0x00,0x00}, {0xAA,0x00,0xAA}, {0xAA,0x55,0x00}, {0xAA,0xAA,0xAA},
+		{0x55,0x55,0x55}, {0x55,0x55,0xFF}, {0x55,0xFF,0x55}, {0x55,0xFF,0xFF},
+		{0xFF,0x55,0x55}, {0xFF,0x55,0xFF}, {0xFF,0xFF,0x55}, {0xFF,0xFF,0xFF}
+	};
+
+	if (!palette_ready) {
+		for (uint8_t i = 0; i < 16; i++)
+			fb4_palette[i] = tft_color565(vga[i][0], vga[i][1], vga[i][2]);
+		fb4_last_color = fb4_palette[0];
+		fb4_last_index = 0;
+		palette_ready = 1;
+	}
+	fb4_w = tft_width();
+	fb4_h = tft_height();
+	fb4_stride = (fb4_w + 1) / 2;
+	fb4_tiles_x = (fb4_w + TFT_FB4_TILE - 1) / TFT_FB4_TILE;
+	fb4_tiles_y = (fb4_h + TFT_FB4_TILE - 1) / TFT_FB4_TILE;
+	memset(fb4_dirty_map, 0, sizeof(fb4_dirty_map));
+	tft_setTarget(&fb4_target);
+}
+
+/**
+ * @brief Desativa o canvas, as primitivas voltam a desenhar direto no LCD
+ */
+void tft_fb4_end(void)
+{
+	if (tft_getTarget() == &fb4_target)
+		tft_setTarget(NULL);
+}
+
+/**
+ * @brief Acesso direto ao buffer ((tft_width()+1)/2 bytes por linha, nibble alto à esquerda)
+ * @details Quem escrever direto no buffer deve chamar tft_fb4_markDirty().
+ */
+uint8_t *tft_fb4_buffer(void)
+{
+	return fb4;
+}
+
+/**
+ * @brief Altera entradas da paleta e marca toda a tela como suja
+ *
+ * @param colors cores RGB565
+ * @param first primeiro índice a alterar
+ * @param n quantidade de entradas
+ */
+void tft_fb4_setPalette(const uint16_t *colors, uint8_t first, uint8_t n)
+{
+	while (n-- > 0 && first < 16)
+		fb4_palette[first++] = *colors++;
+	fb4_last_color = fb4_palette[0];
+	fb4_last_index = 0;
+	fb4_dirty(0, 0, fb4_w, fb4_h);
+}
+
+/**
+ * @brief Marca uma região do canvas para ser enviada no próximo flush
+ */
+void tft_fb4_markDirty(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (x < 0) { w += x; x = 0; }
+	if (y < 0) { h += y; y = 0; }
+	if (x + w > fb4_w) w = fb4_w - x;
+	if (y + h > fb4_h) h = fb4_h - y;
+	if (w > 0 && h > 0)
+		fb4_dirty(x, y, w, h);
+}
+
+/**
+ * @brief Envia ao LCD apenas os blocos alterados
+ * @details Blocos sujos vizinhos na mesma faixa horizontal são enviados em uma
+ * única janela; os nibbles são expandidos pela paleta direto no barramento.
+ */
+void tft_fb4_flush(void)
+{
+	for (int16_t ty = 0; ty < fb4_tiles_y; ty++) {
+		int16_t y0 = ty * TFT_FB4_TILE;
+		int16_t h = (y0 + TFT_FB4_TILE > fb4_h) ? fb4_h - y0 : TFT_FB4_TILE;
+		int16_t tx = 0;
+		while (tx < fb4_tiles_x) {
+			uint16_t t = ty * fb4_tiles_x + tx;
+			if (!(fb4_dirty_map[t >> 3] & (1 << (t & 7)))) {
+				tx++;
+				continue;
+			}
+			int16_t tx0 = tx;
+			do {
+				fb4_dirty_map[t >> 3] &= ~(1 << (t & 7));
+				tx++;
+				t++;
+			} while (tx < fb4_tiles_x && (fb4_dirty_map[t >> 3] & (1 << (t & 7))));
+			int16_t x0 = tx0 * TFT_FB4_TILE;
+			int16_t w = tx * TFT_FB4_TILE;
+			if (w > fb4_w) w = fb4_w;
+			w -= x0;
+			tft_startWrite(x0, y0, w, h);
+			for (int16_t row = y0; row < y0 + h; row++)
+				tft_writeIndexed4(&fb4[(uint32_t)row * fb4_stride + (x0 >> 1)], x0 & 1, fb4_palette, w);
+			tft_endWrite();
+		}
+	}
+}
+
+#endif /* TFT_USE_FB4 */
@@ -0,0 +1,337 @@
+/**
+ ******************************************************************************
+ * @file    tft_image.c
+ * @brief   Decodificadores de imagens comprimidas em flash.
+ ******************************************************************************
+ * @attention
+ *
+ * A parte visível da imagem é enviada em uma única janela, na ordem em
+ * que o decodificador produz os pixels, sem buffer intermediário:
+ * repetições vão por tft_writeColor() e literais por tft_writeColors()
+ * direto da flash. Linhas acima da área visível ainda precisam ser
+ * percorridas (o RLE não permite saltar), mas nada é enviado ao LCD;
+ * a decodificação para na última linha visível.
+ *
+ * O QOI é decodificado linha a linha em qoi_line (só as colunas visíveis)
+ * e cada linha é enviada por tft_writeColors() na mesma janela; a RAM
+ * usada é a linha (2 * máx(WIDTH, HEIGHT) bytes) mais a tabela de 64
+ * cores na pilha, independente do tamanho da imagem.
+ *
+ * Com um alvo instalado (tft_setTarget()) nada vai ao barramento: os
+ * trechos de cada linha vão para o alvo, repetições por fillRect e
+ * literais por writeRect.
+ *
+ * A ampliação/redução de bitmaps RGB565 percorre a origem com passos em
+ * ponto fixo 16.16 (sem divisão por pixel) e envia tudo em uma única
+ * janela recortada. Uma linha de destino que cai na mesma linha de origem
+ * da anterior é reenviada sem ser recalculada; no bilinear as duas linhas
+ * de origem já interpoladas na horizontal ficam guardadas e só são
+ * recalculadas quando a linha de origem muda.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_image.h"
+#include "tft_alpha.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define QOI_LINE_MAX	((WIDTH > HEIGHT) ? WIDTH : HEIGHT)
+
+/* Variáveis privadas -------------------------------------------------------*/
+static uint16_t qoi_line[QOI_LINE_MAX];
+static uint16_t scale_a[QOI_LINE_MAX], scale_b[QOI_LINE_MAX];
+
+/* Funções privadas ---------------------------------------------------------*/
+static uint8_t clip(int16_t *x, int16_t *y, int16_t *w, int16_t *h)
+{
+	if (*x < 0) { *w += *x; *x = 0; }
+	if (*y < 0) { *h += *y; *y = 0; }
+	if (*x + *w > tft_width()) *w = tft_width() - *x;
+	if (*y + *h > tft_height()) *h = tft_height() - *y;
+	return *w > 0 && *h > 0;
+}
+
+/**
+ * @brief Imagem RGB565 crua com (x,y) no canto superior esquerdo, em uma janela
+ */
+static void draw_raw(int16_t x, int16_t y, const uint16_t *px, int16_t w, int16_t h)
+{
+	int16_t cx = x, cy = y, cw = w, ch = h;
+
+	if (!clip(&cx, &cy, &cw, &ch))
+		return;
+	px += (int32_t)(cy - y) * w + (cx - x);
+	const tft_target_t *t = tft_getTarget();
+	if (t) {
+		for (int16_t r = 0; r < ch; r++, px += w)
+			t->writeRect(cx, cy + r, cw, 1, px);
+		return;
+	}
+	tft_startWrite(cx, cy, cw, ch);
+	for (int16_t r = 0; r < ch; r++, px += w)
+		tft_writeColors(px, cw);
+	tft_endWrite();
+}
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Desenha uma imagem RGB565 comprimida em RLE
+ *
+ * @param x,y posição do canto superior esquerdo (pode estar fora da tela)
+ * @param data imagem gerada por Tools/img_encode.c (modo rle)
+ * @return 0 ou -1 se o cabeçalho é inválido
+ */
+int8_t tft_drawRLE(int16_t x, int16_t y, const uint16_t *data)
+{
+	if (data[0] != TFT_IMAGE_RLE)
+		return -1;
+
+	int16_t w = data[1], h = data[2];
+	int16_t cx = x, cy = y, cw = w, ch = h;
+	if (!clip(&cx, &cy, &cw, &ch))
+		return 0;
+
+	/* área visível em coordenadas da imagem */
+	int16_t x0 = cx - x, x1 = x0 + cw;
+	int16_t y0 = cy - y, y1 = y0 + ch;
+	const uint16_t *p = data + 3;
+	int16_t row = 0, col = 0;
+	const tft_target_t *t = tft_getTarget();
+
+	if (!t)
+		tft_startWrite(cx, cy, cw, ch);
+	while (row < y1) {
+		uint16_t ctrl = *p++;
+		uint32_t n = (ctrl & ~TFT_IMAGE_RUN) + 1;
+		uint8_t run = (ctrl & TFT_IMAGE_RUN) != 0;
+		const uint16_t *lit = p;
+		uint16_t color = *p;
+
+		p += run ? 1 : n;
+		while (n && row < y1) {
+			int16_t k = (n < (uint32_t)(w - col)) ? (int16_t)n : w - col;
+			if (row >= y0) {
+				int16_t a = (col > x0) ? col : x0;
+				int16_t b = (col + k < x1) ? col + k : x1;
+				if (a < b && t) {
+					if (run)
+						t->fillRect(x + a, y + row, b - a, 1, color);
+					else
+						t->writeRect(x + a, y + row, b - a, 1, lit + (a - col));
+				} else if (a < b) {
+					if (run)
+						tft_writeColor(color, b - a);
+					else
+						tft_writeColors(lit + (a - col), b - a);
+				}
+			}
+			if (!run)
+				lit += k;
+			n -= k;
+			col += k;
+			if (col == w) {
+				col = 0;
+				row++;
+			}
+		}
+	}
+	if (!t)
+		tft_endWrite();
+	return 0;
+}
+
+/**
+ * @brief Desenha uma imagem comprimida no formato QOI adaptado a RGB565
+ *
+ * @param x,y posição do canto superior esquerdo (pode estar fora da tela)
+ * @param data imagem gerada por Tools/img_encode.c (modo qoi)
+ * @return 0 ou -1 se o cabeçalho é inválido
+ */
+int8_t tft_drawQOI(int16_t x, int16_t y, const uint8_t *data)
+{
+	if (data[0] != 'Q' || data[1] != '6')
+		return -1;
+
+	int16_t w = data[2] | (data[3] << 8), h = data[4] | (data[5] << 8);
+	int16_t cx = x, cy = y, cw = w, ch = h;
+	if (!clip(&cx, &cy, &cw, &ch))
+		return 0;
+
+	int16_t x0 = cx - x, x1 = x0 + cw;
+	int16_t y0 = cy - y, y1 = y0 + ch;
+	const uint8_t *p = data + 6;
+	uint16_t index[64] = { 0 };
+	uint16_t px = 0;
+	uint8_t r = 0, g = 0, b = 0, run = 0;
+	const tft_target_t *t = tft_getTarget();
+
+	if (!t)
+		tft_startWrite(cx, cy, cw, ch);
+	for (int16_t row = 0; row < y1; row++) {
+		uint16_t *out = qoi_line;
+		for (int16_t col = 0; col < w; col++) {
+			if (run) {
+				run--;
+			} else {
+				uint8_t op = *p++;
+				if (op == TFT_QOI_OP_RGB) {
+					px = p[0] | (p[1] << 8);
+					p += 2;
+					r = px >> 11; g = (px >> 5) & 0x3F; b = px & 0x1F;
+				} else {
+					switch (op & TFT_QOI_MASK) {
+					case TFT_QOI_OP_INDEX:
+						px = index[op];
+						r = px >> 11; g = (px >> 5) & 0x3F; b = px & 0x1F;
+						break;
+					case TFT_QOI_OP_DIFF:
+						r = (r + ((op >> 4) & 3) - 2) & 0x1F;
+						g = (g + ((op >> 2) & 3) - 2) & 0x3F;
+						b = (b + (op & 3) - 2) & 0x1F;
+						px = (r << 11) | (g << 5) | b;
+						break;
+					case TFT_QOI_OP_LUMA: {
+						uint8_t rb = *p++;
+						int8_t dg = (op & 0x3F) - 32;
+						r = (r + dg - 8 + (rb >> 4)) & 0x1F;
+						g = (g + dg) & 0x3F;
+						b = (b + dg - 8 + (rb & 0x0F)) & 0x1F;
+						px = (r << 11) | (g << 5) | b;
+						break;
+					}
+					default:
+						run = op & 0x3F;
+						break;
+					}
+				}
+				index[TFT_QOI_HASH(r, g, b)] = px;
+			}
+			if (col >= x0 && col < x1)
+				*out++ = px;
+		}
+		if (row >= y0 && t)
+			t->writeRect(cx, y + row, cw, 1, qoi_line);
+		else if (row >= y0)
+			tft_writeColors(qoi_line, cw);
+	}
+	if (!t)
+		tft_endWrite();
+	return 0;
+}
+
+/**
+ * @brief Interpola na horizontal a linha de origem src para n pixels de destino
+ */
+static void scaleRow(uint16_t *out, const uint16_t *src, int16_t w, uint32_t fx, uint32_t step, int16_t n,
+		uint8_t mode)
+{
+	for (int16_t i = 0; i < n; i++, fx += step) {
+		int16_t sx = fx >> 16;
+		if (mode == TFT_SCALE_NEAREST || sx >= w - 1)
+			out[i] = src[sx];
+		else
+			out[i] = tft_blend565(src[sx + 1], src[sx], (fx >> 8) & 0xFF);
+	}
+}
+
+/**
+ * @brief Desenha um bitmap RGB565 redimensionado para dw x dh
+ * @details Ao contrário de tft_drawRGBBitmap(), (x,y) é o canto superior esquerdo.
+ *
+ * @param x,y canto superior esquerdo do destino (pode estar fora da tela)
+ * @param bitmap pixels de origem, w*h
+ * @param w,h dimensões da origem
+ * @param dw,dh dimensões do destino
+ * @param mode TFT_SCALE_NEAREST ou TFT_SCALE_BILINEAR
+ */
+void tft_drawRGBBitmapScaled(int16_t x, int16_t y, const uint16_t *bitmap, int16_t w, int16_t h, int16_t dw,
+		int16_t dh, uint8_t mode)
+{
+	if (w <= 0 || h <= 0 || dw <= 0 || dh <= 0)
+		return;
+
+	uint32_t stepx = ((uint32_t)w << 16) / dw, stepy = ((uint32_t)h << 16) / dh;
+	/* amostra no centro de cada pixel de destino */
+	int32_t fx0 = stepx >> 1, fy0 = stepy >> 1;
+	if (mode == TFT_SCALE_BILINEAR) {
+		fx0 = (fx0 > 0x8000) ? fx0 - 0x8000 : 0;
+		fy0 = (fy0 > 0x8000) ? fy0 - 0x8000 : 0;
+	}
+
+	int16_t cx = x, cy = y, cw = dw, ch = dh;
+	if (!clip(&cx, &cy, &cw, &ch))
+		return;
+	uint32_t fx = fx0 + (uint32_t)(cx - x) * stepx;
+	uint32_t fy = fy0 + (uint32_t)(cy - y) * stepy;
+	const tft_target_t *t = tft_getTarget();
+	int16_t row_a = -1, row_b = -1, last = -1;
+	uint8_t last_frac = 0;
+
+	if (!t)
+		tft_startWrite(cx, cy, cw, ch);
+	for (int16_t r = 0; r < ch; r++, fy += stepy) {
+		int16_t sy = fy >> 16;
+		uint8_t frac = (mode == TFT_SCALE_BILINEAR && sy < h - 1) ? (fy >> 8) & 0xFF : 0;
+		uint16_t *out = scale_a;
+
+		if (sy != last || frac != last_frac) {
+			if (sy != row_a) {
+				if (sy == row_b) {
+					/* a linha de baixo anterior vira a de cima */
+					memcpy(scale_a, scale_b, cw * sizeof(uint16_t));
+				} else {
+					scaleRow(scale_a, bitmap + (int32_t)sy * w, w, fx, stepx, cw, mode);
+				}
+				row_a = sy;
+			}
+			if (frac) {
+				if (row_b != sy + 1) {
+					scaleRow(scale_b, bitmap + (int32_t)(sy + 1) * w, w, fx, stepx, cw, mode);
+					row_b = sy + 1;
+				}
+				for (int16_t i = 0; i < cw; i++)
+					qoi_line[i] = tft_blend565(scale_b[i], scale_a[i], frac);
+			}
+			last = sy;
+			last_frac = frac;
+		}
+		if (frac)
+			out = qoi_line;
+		if (t)
+			t->writeRect(cx, cy + r, cw, 1, out);
+		else
+			tft_writeColors(out, cw);
+	}
+	if (!t)
+		tft_endWrite();
+}
+
+/**
+ * @brief Compara o tempo de decodificação mais transferência de uma imagem
+ * QOI com o da transferência da mesma imagem crua
+ * @details As duas versões são desenhadas no mesmo retângulo, uma janela recortada
+ * com (x,y) no canto superior esquerdo.
+ *
+ * @param x,y canto superior esquerdo na tela
+ * @param qoi imagem QOI
+ * @param raw a mesma imagem em RGB565 cru
+ * @param n quantidade de repetições de cada desenho
+ * @param qoi_ms,raw_ms tempos totais em ms (HAL_GetTick)
+ */
+void tft_testQOI(int16_t x, int16_t y, const uint8_t *qoi, const uint16_t *raw, uint8_t n, uint32_t *qoi_ms,
+		uint32_t *raw_ms)
+{
+	int16_t w = qoi[2] | (qoi[3] << 8), h = qoi[4] | (qoi[5] << 8);
+	uint32_t t;
+
+	t = HAL_GetTick();
+	for (uint8_t i = 0; i < n; i++)
+		tft_drawQOI(x, y, qoi);
+	*qoi_ms = HAL_GetTick() - t;
+
+	t = HAL_GetTick();
+	for (uint8_t i = 0; i < n; i++)
+		draw_raw(x, y, raw, w, h);
+	*raw_ms = HAL_GetTick() - t;
+}
@@ -0,0 +1,656 @@
+/**
+ ******************************************************************************
+ * @file    tft_jpeg.c
+ * @brief   Decodificador JPEG baseline com saída direta no LCD.
+ ******************************************************************************
+ * @attention
+ *
+ * Fluxo: os marcadores são lidos até o SOS e os dados comprimidos são
+ * decodificados MCU a MCU (Huffman -> desquantização -> IDCT inteira ->
+ * YCbCr para RGB565). Cada MCU vai para o LCD em uma janela recortada
+ * pela tela (ou para o writeRect do alvo instalado com tft_setTarget()); MCUs fora da tela são decodificados mas não enviados, e a
+ * decodificação termina na primeira linha de MCUs abaixo da tela.
+ *
+ * A IDCT é a separável de Loeffler (como a "islow" da libjpeg), com
+ * constantes de 12 bits. Na redução para 1/2 e 1/4 são usadas as IDCTs
+ * reduzidas de 4x4 e 2x2 da libjpeg (jidctred), que só leem os
+ * coeficientes necessários e custam bem menos que a 8x8; em 1/8 cada
+ * bloco vira um pixel pelo DC. O croma é ampliado por repetição.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_jpeg.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define M_SOF0		0xC0
+#define M_SOF1		0xC1
+#define M_DHT		0xC4
+#define M_SOI		0xD8
+#define M_EOI		0xD9
+#define M_SOS		0xDA
+#define M_DQT		0xDB
+#define M_DRI		0xDD
+
+#define F2F(x)		((int32_t)((x) * 4096 + 0.5))
+#define FSH(x)		((x) * 4096)
+
+/* Tipos --------------------------------------------------------------------*/
+typedef struct {
+	uint16_t fast[256];		///< 8 primeiros bits -> (comprimento << 8) | valor
+	int32_t maxcode[18];
+	uint16_t mincode[17];
+	uint16_t valptr[17];
+	uint8_t vals[256];
+} huff_t;
+
+typedef struct {
+	uint8_t id, h, v, tq;	///< identificador, amostragem e tabela de quantização
+	uint8_t td, ta;			///< tabelas de Huffman DC e AC
+	int32_t dc;				///< predição do DC
+} comp_t;
+
+/* Variáveis privadas -------------------------------------------------------*/
+static const uint8_t zigzag[64] = {
+	 0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+	12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+	35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+	58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+static huff_t huff[4];			//DC0, DC1, AC0, AC1
+static uint16_t qt[4][64];		//em ordem zigue-zague
+static comp_t comp[3];
+static uint8_t ncomp, hmax, vmax;
+static uint16_t img_w, img_h, restart;
+
+/* leitor de bits */
+static const uint8_t *bs_p, *bs_end;
+static uint32_t bs_bits;
+static int8_t bs_n;
+static uint8_t bs_marker;
+
+/* MCU: Y até 2x2 blocos, Cb e Cr um bloco cada */
+static int32_t coef[64];
+static uint8_t mcu_y[16 * 16], mcu_cb[64], mcu_cr[64];
+static uint16_t mcu_out[16 * 16];
+
+/* Funções privadas ---------------------------------------------------------*/
+static inline uint8_t clamp8(int32_t v)
+{
+	return (v < 0) ? 0 : (v > 255) ? 255 : v;
+}
+
+static void bits_fill(void)
+{
+	while (bs_n <= 24) {
+		uint32_t c = 0;
+		if (!bs_marker && bs_p < bs_end) {
+			c = *bs_p;
+			if (c == 0xFF) {
+				uint8_t c2 = (bs_p + 1 < bs_end) ? bs_p[1] : 0xD9;
+				if (c2 == 0x00) {
+					bs_p += 2;
+				} else {
+					/* marcador: fica em bs_p e o resto é completado com zeros */
+					bs_marker = c2;
+					c = 0;
+				}
+			} else {
+				bs_p++;
+			}
+		}
+		bs_bits |= c << (24 - bs_n);
+		bs_n += 8;
+	}
+}
+
+static inline uint32_t bits_get(uint8_t n)
+{
+	uint32_t v;
+
+	if (!n)
+		return 0;
+	bits_fill();
+	v = bs_bits >> (32 - n);
+	bs_bits <<= n;
+	bs_n -= n;
+	return v;
+}
+
+static inline int32_t extend(uint32_t v, uint8_t n)
+{
+	return (v < (1u << (n - 1))) ? (int32_t)v - (1 << n) + 1 : (int32_t)v;
+}
+
+static int16_t huff_decode(const huff_t *t)
+{
+	uint16_t e;
+
+	bits_fill();
+	e = t->fast[bs_bits >> 24];
+	if (e >> 8) {
+		bs_bits <<= e >> 8;
+		bs_n -= e >> 8;
+		return e & 0xFF;
+	}
+	for (uint8_t l = 9; l <= 16; l++) {
+		int32_t code = bs_bits >> (32 - l);
+		if (code <= t->maxcode[l]) {
+			bs_bits <<= l;
+			bs_n -= l;
+			return t->vals[t->valptr[l] + code - t->mincode[l]];
+		}
+	}
+	return -1;
+}
+
+static int8_t huff_build(huff_t *t, const uint8_t *counts, const uint8_t *vals)
+{
+	uint16_t code = 0, k = 0;
+
+	memset(t->fast, 0, sizeof(t->fast));
+	for (uint8_t l = 1; l <= 16; l++) {
+		uint8_t n = counts[l - 1];
+		t->valptr[l] = k;
+		t->mincode[l] = code;
+		t->maxcode[l] = n ? code + n - 1 : -1;
+		for (uint8_t i = 0; i < n; i++, k++, code++) {
+			t->vals[k] = vals[k];
+			if (l <= 8) {
+				uint16_t first = code << (8 - l), cnt = 1 << (8 - l);
+				for (uint16_t j = 0; j < cnt; j++)
+					t->fast[first + j] = (l << 8) | vals[k];
+			}
+		}
+		if (code > (1u << l))
+			return -1;
+		code <<= 1;
+	}
+	t->maxcode[17] = 0x7FFFFFFF;
+	return 0;
+}
+
+/**
+ * @brief Trata o marcador RSTn ao fim de um intervalo de reinício
+ */
+static void bits_restart(void)
+{
+	if (!bs_marker) {
+		while (bs_p + 1 < bs_end && !(bs_p[0] == 0xFF && bs_p[1] >= 0xD0 && bs_p[1] <= 0xD7))
+			bs_p++;
+	}
+	if (bs_p + 1 < bs_end && bs_p[1] >= 0xD0 && bs_p[1] <= 0xD7)
+		bs_p += 2;
+	bs_marker = 0;
+	bs_bits = 0;
+	bs_n = 0;
+	for (uint8_t i = 0; i < ncomp; i++)
+		comp[i].dc = 0;
+}
+
+static int8_t decode_block(comp_t *c, uint8_t dc_only)
+{
+	const uint16_t *q = qt[c->tq];
+	int16_t s = huff_decode(&huff[c->td]);
+
+	if (s < 0 || s > 11)
+		return TFT_JPEG_ERR_DATA;
+	c->dc += s ? extend(bits_get(s), s) : 0;
+	memset(coef, 0, sizeof(coef));
+	coef[0] = c->dc * q[0];
+	for (uint8_t k = 1; k < 64;) {
+		int16_t rs = huff_decode(&huff[2 + c->ta]);
+		if (rs < 0)
+			return TFT_JPEG_ERR_DATA;
+		uint8_t r = rs >> 4, n = rs & 0x0F;
+		if (!n) {
+			if (r != 15)
+				break;
+			k += 16;
+			continue;
+		}
+		k += r;
+		if (k > 63)
+			return TFT_JPEG_ERR_DATA;
+		int32_t v = extend(bits_get(n), n);
+		if (!dc_only)
+			coef[zigzag[k]] = v * q[k];
+		k++;
+	}
+	return TFT_JPEG_OK;
+}
+
+/**
+ * @brief IDCT 8x8 de coef para out (stride em bytes)
+ */
+static void idct(uint8_t *out, uint16_t stride)
+{
+	int32_t tmp[64];
+	int32_t *d = coef, *v = tmp;
+
+#define IDCT_1D(s0, s1, s2, s3, s4, s5, s6, s7) \
+	int32_t t0, t1, t2, t3, p1, p2, p3, p4, p5, x0, x1, x2, x3; \
+	p2 = s2; p3 = s6; \
+	p1 = (p2 + p3) * F2F(0.5411961f); \
+	t2 = p1 + p3 * F2F(-1.847759065f); \
+	t3 = p1 + p2 * F2F(0.765366865f); \
+	p2 = s0; p3 = s4; \
+	t0 = FSH(p2 + p3); \
+	t1 = FSH(p2 - p3); \
+	x0 = t0 + t3; x3 = t0 - t3; \
+	x1 = t1 + t2; x2 = t1 - t2; \
+	t0 = s7; t1 = s5; t2 = s3; t3 = s1; \
+	p3 = t0 + t2; p4 = t1 + t3; \
+	p1 = t0 + t3; p2 = t1 + t2; \
+	p5 = (p3 + p4) * F2F(1.175875602f); \
+	t0 = t0 * F2F(0.298631336f); \
+	t1 = t1 * F2F(2.053119869f); \
+	t2 = t2 * F2F(3.072711026f); \
+	t3 = t3 * F2F(1.501321110f); \
+	p1 = p5 + p1 * F2F(-0.899976223f); \
+	p2 = p5 + p2 * F2F(-2.562915447f); \
+	p3 = p3 * F2F(-1.961570560f); \
+	p4 = p4 * F2F(-0.390180644f); \
+	t3 += p1 + p4; \
+	t2 += p2 + p3; \
+	t1 += p2 + p4; \
+	t0 += p1 + p3;
+
+	/* colunas */
+	for (uint8_t i = 0; i < 8; i++, d++, v++) {
+		if (!d[8] && !d[16] && !d[24] && !d[32] && !d[40] && !d[48] && !d[56]) {
+			int32_t dc = d[0] * 4;
+			v[0] = v[8] = v[16] = v[24] = v[32] = v[40] = v[48] = v[56] = dc;
+			continue;
+		}
+		IDCT_1D(d[0], d[8], d[16], d[24], d[32], d[40], d[48], d[56])
+		x0 += 512; x1 += 512; x2 += 512; x3 += 512;
+		v[0] = (x0 + t3) >> 10;
+		v[56] = (x0 - t3) >> 10;
+		v[8] = (x1 + t2) >> 10;
+		v[48] = (x1 - t2) >> 10;
+		v[16] = (x2 + t1) >> 10;
+		v[40] = (x2 - t1) >> 10;
+		v[24] = (x3 + t0) >> 10;
+		v[32] = (x3 - t0) >> 10;
+	}
+
+	/* linhas, com o deslocamento de nível (+128) */
+	v = tmp;
+	for (uint8_t i = 0; i < 8; i++, v += 8, out += stride) {
+		IDCT_1D(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7])
+		x0 += 65536 + (128 << 17);
+		x1 += 65536 + (128 << 17);
+		x2 += 65536 + (128 << 17);
+		x3 += 65536 + (128 << 17);
+		out[0] = clamp8((x0 + t3) >> 17);
+		out[7] = clamp8((x0 - t3) >> 17);
+		out[1] = clamp8((x1 + t2) >> 17);
+		out[6] = clamp8((x1 - t2) >> 17);
+		out[2] = clamp8((x2 + t1) >> 17);
+		out[5] = clamp8((x2 - t1) >> 17);
+		out[3] = clamp8((x3 + t0) >> 17);
+		out[4] = clamp8((x3 - t0) >> 17);
+	}
+#undef IDCT_1D
+}
+
+/**
+ * @brief IDCT reduzida: 4x4 pixels a partir dos coeficientes de frequência baixa
+ * @details Mesma construção da jpeg_idct_4x4 da libjpeg: a linha e a coluna 4 não
+ * entram e as frequências ímpares são combinadas direto nos 4 pontos de saída.
+ */
+static void idct4(uint8_t *out, uint16_t stride)
+{
+	int32_t tmp[32];
+	int32_t *d = coef, *v = tmp;
+
+#define IDCT4_1D(s0, s1, s2, s3, s5, s6, s7) \
+	int32_t t0, t2, t10, t12; \
+	t0 = (s0) * FSH(2); \
+	t2 = (s2) * F2F(1.847759065f) + (s6) * F2F(-0.765366865f); \
+	t10 = t0 + t2; \
+	t12 = t0 - t2; \
+	t0 = (s7) * F2F(-0.211164243f) + (s5) * F2F(1.451774981f) \
+			+ (s3) * F2F(-2.172734803f) + (s1) * F2F(1.061594337f); \
+	t2 = (s7) * F2F(-0.509795579f) + (s5) * F2F(-0.601344887f) \
+			+ (s3) * F2F(0.899976223f) + (s1) * F2F(2.562915447f);
+
+	/* colunas (a 4 não é usada pelas linhas) */
+	for (uint8_t i = 0; i < 8; i++, d++, v++) {
+		if (i == 4)
+			continue;
+		if (!d[8] && !d[16] && !d[24] && !d[40] && !d[48] && !d[56]) {
+			v[0] = v[8] = v[16] = v[24] = d[0] * 4;
+			continue;
+		}
+		IDCT4_1D(d[0], d[8], d[16], d[24], d[40], d[48], d[56])
+		v[0] = (t10 + t2 + 1024) >> 11;
+		v[24] = (t10 - t2 + 1024) >> 11;
+		v[8] = (t12 + t0 + 1024) >> 11;
+		v[16] = (t12 - t0 + 1024) >> 11;
+	}
+
+	/* linhas, com o deslocamento de nível (+128) */
+	v = tmp;
+	for (uint8_t i = 0; i < 4; i++, v += 8, out += stride) {
+		IDCT4_1D(v[0], v[1], v[2], v[3], v[5], v[6], v[7])
+		t10 += 131072 + (128 << 18);
+		t12 += 131072 + (128 << 18);
+		out[0] = clamp8((t10 + t2) >> 18);
+		out[3] = clamp8((t10 - t2) >> 18);
+		out[1] = clamp8((t12 + t0) >> 18);
+		out[2] = clamp8((t12 - t0) >> 18);
+	}
+#undef IDCT4_1D
+}
+
+/**
+ * @brief IDCT reduzida: 2x2 pixels, como a jpeg_idct_2x2 da libjpeg (só DC e frequências ímpares)
+ */
+static void idct2(uint8_t *out, uint16_t stride)
+{
+	int32_t tmp[16];
+	int32_t *d = coef, *v = tmp;
+
+#define IDCT2_1D(s0, s1, s3, s5, s7) \
+	int32_t t10 = (s0) * FSH(4); \
+	int32_t t0 = (s7) * F2F(-0.720959822f) + (s5) * F2F(0.850430095f) \
+			+ (s3) * F2F(-1.272758580f) + (s1) * F2F(3.624509785f);
+
+	/* colunas 0, 1, 3, 5 e 7 */
+	for (uint8_t i = 0; i < 8; i++, d++, v++) {
+		if (i == 2 || i == 4 || i == 6)
+			continue;
+		if (!d[8] && !d[24] && !d[40] && !d[56]) {
+			v[0] = v[8] = d[0] * 4;
+			continue;
+		}
+		IDCT2_1D(d[0], d[8], d[24], d[40], d[56])
+		v[0] = (t10 + t0 + 2048) >> 12;
+		v[8] = (t10 - t0 + 2048) >> 12;
+	}
+
+	/* linhas, com o deslocamento de nível (+128) */
+	v = tmp;
+	for (uint8_t i = 0; i < 2; i++, v += 8, out += stride) {
+		IDCT2_1D(v[0], v[1], v[3], v[5], v[7])
+		t10 += 262144 + (128 << 19);
+		out[0] = clamp8((t10 + t0) >> 19);
+		out[1] = clamp8((t10 - t0) >> 19);
+	}
+#undef IDCT2_1D
+}
+
+/**
+ * @brief Gera o bloco (8 >> scale) x (8 >> scale) em out a partir de coef
+ */
+static void block_out(uint8_t *out, uint16_t stride, uint8_t scale)
+{
+	switch (scale) {
+	case TFT_JPEG_SCALE_1:
+		idct(out, stride);
+		break;
+	case TFT_JPEG_SCALE_1_2:
+		idct4(out, stride);
+		break;
+	case TFT_JPEG_SCALE_1_4:
+		idct2(out, stride);
+		break;
+	default:
+		*out = clamp8(128 + ((coef[0] + 4) >> 3));
+		break;
+	}
+}
+
+/**
+ * @brief Converte o MCU para RGB565 e envia a parte visível
+ */
+static void mcu_flush(int16_t sx, int16_t sy, int16_t mw, int16_t w, int16_t h)
+{
+	int16_t x0 = 0, y0 = 0;
+
+	/* recorte pela tela; w e h já vêm recortados pela imagem */
+	if (sx < 0) { x0 = -sx; w += sx; sx = 0; }
+	if (sy < 0) { y0 = -sy; h += sy; sy = 0; }
+	if (sx + w > tft_width()) w = tft_width() - sx;
+	if (sy + h > tft_height()) h = tft_height() - sy;
+	if (w <= 0 || h <= 0)
+		return;
+
+	uint16_t *o = mcu_out;
+	uint8_t cw = mw / hmax;
+	for (int16_t py = y0; py < y0 + h; py++) {
+		const uint8_t *yl = &mcu_y[py * mw];
+		for (int16_t px = x0; px < x0 + w; px++) {
+			int32_t Y = yl[px];
+			if (ncomp == 1) {
+				*o++ = ((Y & 0xF8) << 8) | ((Y & 0xFC) << 3) | (Y >> 3);
+				continue;
+			}
+			uint16_t ci = (py / vmax) * cw + px / hmax;
+			int32_t cb = mcu_cb[ci] - 128, cr = mcu_cr[ci] - 128;
+			Y = (Y << 16) + 32768;
+			uint8_t r = clamp8((Y + 91881 * cr) >> 16);
+			uint8_t g = clamp8((Y - 22554 * cb - 46802 * cr) >> 16);
+			uint8_t b = clamp8((Y + 116130 * cb) >> 16);
+			*o++ = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+		}
+	}
+	const tft_target_t *t = tft_getTarget();
+	if (t) {
+		t->writeRect(sx, sy, w, h, mcu_out);
+		return;
+	}
+	tft_startWrite(sx, sy, w, h);
+	tft_writeColors(mcu_out, (uint32_t)w * h);
+	tft_endWrite();
+}
+
+/**
+ * @brief Lê os marcadores até o SOS (ou só até o SOF se header_only)
+ * @return ponteiro para os dados comprimidos, NULL em erro (código em *err)
+ */
+static const uint8_t *parse_headers(const uint8_t *p, const uint8_t *end, uint8_t header_only, int8_t *err)
+{
+	uint8_t have_sof = 0;
+
+	*err = TFT_JPEG_ERR_FORMAT;
+	if (end - p < 4 || p[0] != 0xFF || p[1] != M_SOI)
+		return NULL;
+	p += 2;
+	restart = 0;
+	while (end - p >= 4) {
+		if (p[0] != 0xFF)
+			return NULL;
+		uint8_t m = p[1];
+		if (m == 0xFF) {
+			p++;
+			continue;
+		}
+		if (m == M_EOI)
+			return NULL;
+		uint16_t len = (p[2] << 8) | p[3];
+		const uint8_t *s = p + 4, *se = p + 2 + len;
+		if (len < 2 || se > end)
+			return NULL;
+
+		switch (m) {
+		case M_SOF0:
+		case M_SOF1:
+			if (len < 8 || s[0] != 8) {
+				*err = TFT_JPEG_ERR_UNSUPPORTED;
+				return NULL;
+			}
+			img_h = (s[1] << 8) | s[2];
+			img_w = (s[3] << 8) | s[4];
+			ncomp = s[5];
+			if (!img_w || !img_h || (ncomp != 1 && ncomp != 3) || len < 8 + 3 * ncomp)
+				return NULL;
+			hmax = vmax = 1;
+			for (uint8_t i = 0; i < ncomp; i++) {
+				comp[i].id = s[6 + 3 * i];
+				comp[i].h = s[7 + 3 * i] >> 4;
+				comp[i].v = s[7 + 3 * i] & 0x0F;
+				comp[i].tq = s[8 + 3 * i] & 3;
+				if (ncomp == 1)
+					comp[i].h = comp[i].v = 1;
+				if (!comp[i].h || comp[i].h > 2 || !comp[i].v || comp[i].v > 2 || (i && (comp[i].h != 1 || comp[i].v != 1))) {
+					*err = TFT_JPEG_ERR_UNSUPPORTED;
+					return NULL;
+				}
+			}
+			hmax = comp[0].h;
+			vmax = comp[0].v;
+			have_sof = 1;
+			if (header_only) {
+				*err = TFT_JPEG_OK;
+				return s;
+			}
+			break;
+
+		case M_DHT:
+			while (s + 17 <= se) {
+				uint8_t tc = s[0] >> 4, th = s[0] & 0x0F;
+				uint16_t total = 0;
+				for (uint8_t i = 0; i < 16; i++)
+					total += s[1 + i];
+				if (tc > 1 || th > 1 || total > 256 || s + 17 + total > se)
+					return NULL;
+				if (huff_build(&huff[tc * 2 + th], s + 1, s + 17) < 0)
+					return NULL;
+				s += 17 + total;
+			}
+			break;
+
+		case M_DQT:
+			while (s < se) {
+				uint8_t pq = s[0] >> 4, tq = s[0] & 0x0F;
+				if (tq > 3 || s + 1 + 64 * (pq + 1) > se)
+					return NULL;
+				for (uint8_t i = 0; i < 64; i++)
+					qt[tq][i] = pq ? (s[1 + 2 * i] << 8) | s[2 + 2 * i] : s[1 + i];
+				s += 1 + 64 * (pq + 1);
+			}
+			break;
+
+		case M_DRI:
+			restart = (s[0] << 8) | s[1];
+			break;
+
+		case M_SOS:
+			if (!have_sof || s[0] != ncomp || len < 6 + 2 * ncomp)
+				return NULL;
+			for (uint8_t i = 0; i < ncomp; i++) {
+				uint8_t id = s[1 + 2 * i], t = s[2 + 2 * i];
+				comp_t *c = NULL;
+				for (uint8_t j = 0; j < ncomp; j++)
+					if (comp[j].id == id)
+						c = &comp[j];
+				if (!c || (t >> 4) > 1 || (t & 0x0F) > 1)
+					return NULL;
+				c->td = t >> 4;
+				c->ta = t & 0x0F;
+			}
+			*err = TFT_JPEG_OK;
+			return se;
+
+		default:
+			/* SOF2..SOF15 (exceto DHT, JPG e DAC): progressivo, sem perdas, aritmético */
+			if (m > M_SOF1 && m <= 0xCF && m != 0xC8 && m != 0xCC) {
+				*err = TFT_JPEG_ERR_UNSUPPORTED;
+				return NULL;
+			}
+			break;
+		}
+		p = se;
+	}
+	return NULL;
+}
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Lê as dimensões de uma imagem JPEG
+ *
+ * @param data,size arquivo JPEG
+ * @param w,h largura e altura em pixels (sem redução)
+ * @return TFT_JPEG_OK ou código de erro
+ */
+int8_t tft_jpegSize(const uint8_t *data, uint32_t size, uint16_t *w, uint16_t *h)
+{
+	int8_t err;
+
+	if (!parse_headers(data, data + size, 1, &err))
+		return err;
+	*w = img_w;
+	*h = img_h;
+	return TFT_JPEG_OK;
+}
+
+/**
+ * @brief Decodifica e desenha uma imagem JPEG baseline
+ *
+ * @param x,y posição do canto superior esquerdo (pode estar fora da tela)
+ * @param data,size arquivo JPEG (por exemplo em flash)
+ * @param scale TFT_JPEG_SCALE_1, _1_2, _1_4 ou _1_8
+ * @return TFT_JPEG_OK ou código de erro
+ */
+int8_t tft_drawJPEG(int16_t x, int16_t y, const uint8_t *data, uint32_t size, uint8_t scale)
+{
+	int8_t err;
+	const uint8_t *p = parse_headers(data, data + size, 0, &err);
+
+	if (!p)
+		return err;
+	if (scale > TFT_JPEG_SCALE_1_8)
+		scale = TFT_JPEG_SCALE_1_8;
+
+	uint8_t s = 8 >> scale;
+	int16_t mw = hmax * s, mh = vmax * s;
+	uint16_t mcux = (img_w + 8 * hmax - 1) / (8 * hmax);
+	uint16_t mcuy = (img_h + 8 * vmax - 1) / (8 * vmax);
+	int16_t sw = (img_w + (1 << scale) - 1) >> scale;
+	int16_t sh = (img_h + (1 << scale) - 1) >> scale;
+	uint16_t todo = restart;
+
+	bs_p = p;
+	bs_end = data + size;
+	bs_bits = 0;
+	bs_n = 0;
+	bs_marker = 0;
+	for (uint8_t i = 0; i < ncomp; i++)
+		comp[i].dc = 0;
+
+	for (uint16_t my = 0; my < mcuy; my++) {
+		int16_t sy = y + my * mh;
+		if (sy >= tft_height())
+			break;
+		for (uint16_t mx = 0; mx < mcux; mx++) {
+			if (restart) {
+				if (!todo) {
+					bits_restart();
+					todo = restart;
+				}
+				todo--;
+			}
+			for (uint8_t i = 0; i < ncomp; i++) {
+				comp_t *c = &comp[i];
+				for (uint8_t v = 0; v < c->v; v++) {
+					for (uint8_t h = 0; h < c->h; h++) {
+						if ((err = decode_block(c, scale == TFT_JPEG_SCALE_1_8)) != TFT_JPEG_OK)
+							return err;
+						if (i == 0)
+							block_out(&mcu_y[v * s * mw + h * s], mw, scale);
+						else
+							block_out((i == 1) ? mcu_cb : mcu_cr, s, scale);
+					}
+				}
+			}
+			int16_t w = sw - mx * mw, h = sh - my * mh;
+			mcu_flush(x + mx * mw, sy, mw, (w < mw) ? w : mw, (h < mh) ? h : mh);
+		}
+	}
+	return TFT_JPEG_OK;
+}
@@ -0,0 +1,148 @@
+/**
+ ******************************************************************************
+ * @file    tft_pipe.c
+ * @brief   Desenho em faixas com dois buffers (ping-pong).
+ ******************************************************************************
+ * @attention
+ *
+ * A região é dividida em faixas de altura buffer/(2*w) linhas. A faixa n é
+ * entregue ao transmissor e, sem esperar, a faixa n+1 é gerada no outro
+ * buffer; só então espera-se o fim da transmissão de n. Na última faixa
+ * não há o que gerar, espera-se a transmissão e a janela é fechada.
+ * O barramento desta placa é feito por GPIO pela própria CPU, então a
+ * sobreposição só ocorre no modo assíncrono (interrupção de timer); no
+ * modo síncrono a ordem é a mesma, sem sobreposição. Enquanto espera,
+ * o laço principal também envia pixels, então um timer parado não trava
+ * o desenho.
+ * No modo assíncrono a função de render roda enquanto a interrupção
+ * escreve no barramento, então ela só deve preencher o buffer: chamar
+ * primitivas tft_* de dentro dela misturaria comandos com os pixels da
+ * janela aberta.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_pipe.h"
+
+/* Variáveis privadas -------------------------------------------------------*/
+static uint16_t pipe_mem[TFT_PIPE_BYTES / sizeof(uint16_t)];
+static uint16_t *pipe_buf = pipe_mem;
+static uint32_t pipe_pixels = TFT_PIPE_BYTES / sizeof(uint16_t);
+
+static const uint16_t * volatile tx_ptr;
+static volatile uint32_t tx_left;
+static volatile uint8_t tx_busy;		//um trecho está sendo escrito no barramento
+
+/* Funções privadas ---------------------------------------------------------*/
+static void pipe_send(const uint16_t *block, uint32_t n)
+{
+#if defined(TFT_PIPE_ASYNC)
+	tx_ptr = block;
+	tx_left = n;
+#else
+	tft_writeColors(block, n);
+#endif
+}
+
+static void pipe_wait(void)
+{
+	while (tx_left)
+		tft_pipe_service();
+}
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Troca o buffer das faixas, por exemplo por uma área de RAM livre maior
+ *
+ * @param mem buffer (NULL volta ao buffer interno de TFT_PIPE_BYTES)
+ * @param bytes tamanho do buffer em bytes
+ */
+void tft_pipe_setBuffer(uint16_t *mem, uint32_t bytes)
+{
+	if (mem) {
+		pipe_buf = mem;
+		pipe_pixels = bytes / sizeof(uint16_t);
+	} else {
+		pipe_buf = pipe_mem;
+		pipe_pixels = TFT_PIPE_BYTES / sizeof(uint16_t);
+	}
+}
+
+/**
+ * @brief Desenha uma região gerada faixa a faixa pela aplicação
+ * @details A região precisa estar dentro da tela. Com um alvo de desenho
+ * instalado as faixas vão para o alvo, sem sobreposição.
+ *
+ * @param x,y,w,h região na tela
+ * @param render função que gera as linhas de cada faixa
+ * @param ctx ponteiro repassado para render
+ */
+void tft_pipe_draw(int16_t x, int16_t y, int16_t w, int16_t h, tft_pipe_render_t render, void *ctx)
+{
+	const tft_target_t *t = tft_getTarget();
+	int16_t band = (w > 0) ? pipe_pixels / 2 / w : 0;
+	uint16_t *buf[2];
+	uint8_t cur = 0;
+
+	if (band < 1 || h <= 0)
+		return;
+	if (band > h)
+		band = h;
+	buf[0] = pipe_buf;
+	buf[1] = pipe_buf + (uint32_t)band * w;
+
+	int16_t row = 0, rows = band;
+	render(buf[0], 0, rows, w, ctx);
+	if (!t)
+		tft_startWrite(x, y, w, h);
+	while (1) {
+		if (t)
+			t->writeRect(x, y + row, w, rows, buf[cur]);
+		else
+			pipe_send(buf[cur], (uint32_t)rows * w);
+		int16_t next = row + rows;
+		int16_t next_rows = (h - next < band) ? h - next : band;
+		if (next_rows > 0)
+			render(buf[cur ^ 1], next, next_rows, w, ctx);
+		pipe_wait();
+		if (next_rows <= 0)
+			break;
+		row = next;
+		rows = next_rows;
+		cur ^= 1;
+	}
+	if (!t)
+		tft_endWrite();
+}
+
+/**
+ * @brief Envia o próximo trecho da faixa em transmissão
+ * @details No modo assíncrono deve ser chamada pela interrupção de um timer
+ * (por exemplo em HAL_TIM_PeriodElapsedCallback). As interrupções ficam
+ * mascaradas só para retirar o trecho da fila; a escrita no barramento é
+ * feita com elas habilitadas. Se a interrupção chega enquanto o laço
+ * principal escreve um trecho, ela retorna sem enviar nada.
+ */
+void tft_pipe_service(void)
+{
+	const uint16_t *p;
+	uint32_t n, primask = __get_PRIMASK();
+
+	__disable_irq();
+	n = tx_left;
+	if (tx_busy || !n) {
+		__set_PRIMASK(primask);
+		return;
+	}
+	if (n > TFT_PIPE_CHUNK)
+		n = TFT_PIPE_CHUNK;
+	p = tx_ptr;
+	tx_ptr = p + n;
+	tx_left -= n;
+	tx_busy = 1;
+	__set_PRIMASK(primask);
+
+	tft_writeColors(p, n);
+	tx_busy = 0;
+}
@@ -0,0 +1,191 @@
+/**
+ ******************************************************************************
+ * @file    tft_pixconv.c
+ * @brief   Conversões de formato de pixel em bloco.
+ ******************************************************************************
+ * @attention
+ *
+ * Dois pixels RGB565 cabem em uma palavra e as conversões 565/555 e a
+ * troca de R e B só movem bits dentro de cada metade, então são feitas
+ * com máscaras nas duas metades de uma vez. RGB888 e RGB666 andam de
+ * quatro em quatro pixels, que ocupam três palavras inteiras. As leituras e escritas de
+ * palavras usam memcpy, que no Cortex-M4 vira um LDR/STR (acesso
+ * desalinhado permitido) e no PC continua correto.
+ * No YUV 4:2:2 os dois pixels que compartilham U e V são calculados
+ * juntos: R e B dos dois em uma palavra e G em outra, com soma e
+ * subtração saturadas por byte (__UQADD8/__UQSUB8) no lugar dos testes
+ * de limite.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_pixconv.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#define PIXCONV_SIMD	1
+#endif
+
+/* Funções privadas ---------------------------------------------------------*/
+static inline uint32_t load32(const void *p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static inline void store32(void *p, uint32_t v)
+{
+	memcpy(p, &v, 4);
+}
+
+static inline uint8_t clamp8(int32_t v)
+{
+	return (v < 0) ? 0 : (v > 255) ? 255 : v;
+}
+
+static inline uint32_t rgb565_to_555_2(uint32_t c)
+{
+	return (c & 0xFFC0FFC0) | ((c & 0x001F001F) << 1) | (c & 0x00010001);
+}
+
+static inline uint32_t rgb555_to_565_2(uint32_t c)
+{
+	return (c & 0xFFC0FFC0) | ((c & 0x04000400) >> 5) | ((c >> 1) & 0x001F001F);
+}
+
+static inline uint32_t swap_rb_2(uint32_t c)
+{
+	return (c & 0x07E007E0) | ((c >> 11) & 0x001F001F) | ((c << 11) & 0xF800F800);
+}
+
+static inline uint32_t swap_bytes_2(uint32_t c)
+{
+#ifdef PIXCONV_SIMD
+	return __REV16(c);
+#else
+	return ((c & 0xFF00FF00) >> 8) | ((c & 0x00FF00FF) << 8);
+#endif
+}
+
+/* Aplica op a dois pixels por vez; o último pixel ímpar vai sozinho */
+#define PIXCONV_PAIRS(in, out, n, op) \
+	do { \
+		while ((n) >= 2) { \
+			store32((out), op(load32(in))); \
+			(in) += 2; (out) += 2; (n) -= 2; \
+		} \
+		if (n) \
+			*(out) = (uint16_t)op(*(in)); \
+	} while (0)
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief RGB888 (bytes r, g, b) para RGB565
+ * @details Quatro pixels (12 bytes) são lidos em três palavras e gravados em duas.
+ */
+void tft_rgb888_to_565(const uint8_t *in, uint16_t *out, uint32_t n)
+{
+	for (; n >= 4; n -= 4, in += 12, out += 4) {
+		uint32_t a = load32(in), b = load32(in + 4), c = load32(in + 8);
+		/* a = r0 g0 b0 r1, b = g1 b1 r2 g2, c = b2 r3 g3 b3 (byte baixo primeiro) */
+		uint32_t p0 = ((a & 0xF8) << 8) | ((a >> 5) & 0x07E0) | ((a >> 19) & 0x1F);
+		uint32_t p1 = ((a >> 16) & 0xF800) | ((b & 0xFC) << 3) | ((b >> 11) & 0x1F);
+		uint32_t p2 = ((b >> 8) & 0xF800) | ((b >> 21) & 0x07E0) | ((c >> 3) & 0x1F);
+		uint32_t p3 = (c & 0xF800) | ((c >> 13) & 0x07E0) | (c >> 27);
+		store32(out, p0 | (p1 << 16));
+		store32(out + 2, p2 | (p3 << 16));
+	}
+	while (n--) {
+		*out++ = ((in[0] & 0xF8) << 8) | ((in[1] & 0xFC) << 3) | (in[2] >> 3);
+		in += 3;
+	}
+}
+
+/**
+ * @brief RGB565 para RGB666 em 3 bytes (r, g, b com os bits baixos zerados), como write24()
+ * @details Quatro pixels são lidos em duas palavras e gravados em três (12 bytes).
+ */
+void tft_565_to_666(const uint16_t *in, uint8_t *out, uint32_t n)
+{
+	for (; n >= 4; n -= 4, in += 4, out += 12) {
+		uint32_t a = load32(in), b = load32(in + 2);
+		store32(out, ((a >> 8) & 0xF8) | ((a << 5) & 0xFC00) | ((a << 19) & 0xF80000) | (a & 0xF8000000));
+		store32(out + 4, ((a >> 19) & 0xFC) | ((a >> 5) & 0xF800) | ((b << 8) & 0xF80000) | ((b << 21) & 0xFC000000));
+		store32(out + 8, ((b << 3) & 0xF8) | ((b >> 16) & 0xF800) | ((b >> 3) & 0xFC0000) | ((b << 11) & 0xF8000000));
+	}
+	while (n--) {
+		uint16_t c = *in++;
+		out[0] = (c & 0xF800) >> 8;
+		out[1] = (c & 0x07E0) >> 3;
+		out[2] = (c & 0x001F) << 3;
+		out += 3;
+	}
+}
+
+/**
+ * @brief RGB565 para RGB555 do modo 555 do ILI9488 (perde o bit baixo do verde)
+ */
+void tft_565_to_555(const uint16_t *in, uint16_t *out, uint32_t n)
+{
+	PIXCONV_PAIRS(in, out, n, rgb565_to_555_2);
+}
+
+/**
+ * @brief RGB555 do modo 555 do ILI9488 para RGB565
+ */
+void tft_555_to_565(const uint16_t *in, uint16_t *out, uint32_t n)
+{
+	PIXCONV_PAIRS(in, out, n, rgb555_to_565_2);
+}
+
+/**
+ * @brief Troca R e B (RGB565 <-> BGR565)
+ */
+void tft_swapRB565(const uint16_t *in, uint16_t *out, uint32_t n)
+{
+	PIXCONV_PAIRS(in, out, n, swap_rb_2);
+}
+
+/**
+ * @brief Troca os bytes de cada pixel (big-endian <-> little-endian)
+ */
+void tft_swapBytes16(const uint16_t *in, uint16_t *out, uint32_t n)
+{
+	PIXCONV_PAIRS(in, out, n, swap_bytes_2);
+}
+
+/**
+ * @brief YUV 4:2:2 na ordem Y0 U Y1 V (saída padrão da OV7670) para RGB565
+ *
+ * @param in 2 bytes por pixel
+ * @param out pixels RGB565
+ * @param n quantidade de pixels (par)
+ */
+void tft_yuv422_to_565(const uint8_t *in, uint16_t *out, uint32_t n)
+{
+	for (n >>= 1; n > 0; n--, in += 4, out += 2) {
+		int32_t u = in[1] - 128, v = in[3] - 128;
+		int32_t ro = (359 * v) >> 8;				//1,402 V
+		int32_t go = (88 * u + 183 * v) >> 8;		//0,344 U + 0,714 V
+		int32_t bo = (454 * u) >> 8;				//1,772 U
+#ifdef PIXCONV_SIMD
+		uint32_t y2 = in[0] | (in[2] << 8);
+		uint32_t yy = y2 | (y2 << 16);
+		uint32_t rp = clamp8(ro), rn = clamp8(-ro), bp = clamp8(bo), bn = clamp8(-bo);
+		uint32_t gp = clamp8(-go), gn = clamp8(go);
+		/* bytes 0 e 1: R dos dois pixels; bytes 2 e 3: B */
+		uint32_t rb = __UQSUB8(__UQADD8(yy, (rp | rp << 8) | ((bp | bp << 8) << 16)),
+				(rn | rn << 8) | ((bn | bn << 8) << 16));
+		uint32_t g = __UQSUB8(__UQADD8(y2, gp | gp << 8), gn | gn << 8);
+		out[0] = ((rb & 0xF8) << 8) | ((g & 0xFC) << 3) | ((rb >> 19) & 0x1F);
+		out[1] = (rb & 0xF800) | ((g & 0xFC00) >> 5) | (rb >> 27);
+#else
+		for (uint8_t k = 0; k < 2; k++) {
+			int32_t y = in[2 * k];
+			out[k] = ((clamp8(y + ro) & 0xF8) << 8) | ((clamp8(y - go) & 0xFC) << 3) | (clamp8(y + bo) >> 3);
+		}
+#endif
+	}
+}
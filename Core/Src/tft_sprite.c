@@ -0,0 +1,219 @@
+/**
+ ******************************************************************************
+ * @file    tft_sprite.c
+ * @brief   Sprites com cor transparente e restauração do fundo.
+ ******************************************************************************
+ * @attention
+ *
+ * O sprite é sempre composto sobre o fundo em RAM e enviado em uma única
+ * janela, então os pixels transparentes não custam janelas extras e não há
+ * piscada. Ao mover por (dx,dy):
+ *  - a parte da posição antiga que fica descoberta é restaurada do fundo;
+ *  - o buffer de fundo é deslocado, a parte comum às duas posições já está
+ *    nele e só a faixa nova é lida da GRAM com tft_readGRAM();
+ *  - o sprite é desenhado na nova posição.
+ * A leitura da GRAM exige que o desenho vá direto para o LCD (sem alvo
+ * instalado); sem buffer de fundo o sprite usa a cor bgcolor.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_sprite.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define SPRITE_LINE_MAX	((WIDTH > HEIGHT) ? WIDTH : HEIGHT)
+
+/* Variáveis privadas -------------------------------------------------------*/
+static uint16_t sprite_line[SPRITE_LINE_MAX];
+
+/* Funções privadas ---------------------------------------------------------*/
+static uint8_t clip(int16_t *x, int16_t *y, int16_t *w, int16_t *h)
+{
+	if (*x < 0) { *w += *x; *x = 0; }
+	if (*y < 0) { *h += *y; *y = 0; }
+	if (*x + *w > tft_width()) *w = tft_width() - *x;
+	if (*y + *h > tft_height()) *h = tft_height() - *y;
+	return *w > 0 && *h > 0;
+}
+
+/**
+ * @brief Envia ao LCD uma região dentro do retângulo atual do sprite
+ *
+ * @param x,y,w,h região em coordenadas de tela
+ * @param with_sprite 0: apenas o fundo; 1: sprite composto sobre o fundo
+ */
+static void sprite_write(const tft_sprite_t *s, int16_t x, int16_t y, int16_t w, int16_t h, uint8_t with_sprite)
+{
+	const tft_target_t *t = tft_getTarget();
+
+	if (!clip(&x, &y, &w, &h))
+		return;
+	if (!t)
+		tft_startWrite(x, y, w, h);
+	for (int16_t row = y - s->y; row < y - s->y + h; row++) {
+		int32_t i = (int32_t)row * s->w + (x - s->x);
+		for (int16_t col = 0; col < w; col++, i++) {
+			uint16_t color;
+			uint8_t transparent = 1;
+			if (with_sprite) {
+				if (s->palette) {
+					uint8_t v = ((const uint8_t *)s->pixels)[i];
+					transparent = (v == s->key);
+					color = s->palette[v];
+				} else {
+					color = ((const uint16_t *)s->pixels)[i];
+					transparent = (color == s->key);
+				}
+			}
+			if (transparent)
+				color = s->background ? s->background[i] : s->bgcolor;
+			sprite_line[col] = color;
+		}
+		if (t)
+			t->writeRect(x, s->y + row, w, 1, sprite_line);
+		else
+			tft_writeColors(sprite_line, w);
+	}
+	if (!t)
+		tft_endWrite();
+}
+
+/**
+ * @brief Lê da GRAM uma região dentro do retângulo atual do sprite para o buffer de fundo
+ */
+static void sprite_save(tft_sprite_t *s, int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	if (!s->background || !clip(&x, &y, &w, &h))
+		return;
+	for (int16_t row = 0; row < h; row++)
+		tft_readGRAM(x, y + row, &s->background[(int32_t)(y + row - s->y) * s->w + (x - s->x)], w, 1);
+}
+
+/**
+ * @brief Desloca o buffer de fundo: fundo_novo[r][c] = fundo_antigo[r+dy][c+dx]
+ */
+static void sprite_shift(tft_sprite_t *s, int16_t dx, int16_t dy)
+{
+	int16_t c0 = (dx < 0) ? -dx : 0;
+	int16_t n = s->w - ((dx < 0) ? -dx : dx);
+	int16_t rows = s->h - ((dy < 0) ? -dy : dy);
+
+	for (int16_t k = 0; k < rows; k++) {
+		int16_t r = (dy >= 0) ? k : s->h - 1 - k;
+		memmove(&s->background[(int32_t)r * s->w + c0],
+				&s->background[(int32_t)(r + dy) * s->w + c0 + dx], n * sizeof(uint16_t));
+	}
+}
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Prepara um sprite (não desenha)
+ *
+ * @param s sprite
+ * @param pixels imagem w*h, RGB565 ou índices de 8 bits
+ * @param palette paleta RGB565 para imagens indexadas, NULL para RGB565
+ * @param w largura
+ * @param h altura
+ * @param key cor RGB565 (ou índice) transparente, TFT_SPRITE_NOKEY para nenhuma
+ * @param background buffer de w*h pixels para guardar o fundo, NULL para fundo de cor fixa
+ * @param bgcolor cor do fundo quando background é NULL
+ */
+void tft_sprite_init(tft_sprite_t *s, const void *pixels, const uint16_t *palette, int16_t w, int16_t h,
+		int32_t key, uint16_t *background, uint16_t bgcolor)
+{
+	s->pixels = pixels;
+	s->palette = palette;
+	s->w = w;
+	s->h = h;
+	s->key = key;
+	s->background = background;
+	s->bgcolor = bgcolor;
+	s->x = s->y = 0;
+	s->visible = 0;
+}
+
+/**
+ * @brief Guarda o fundo e desenha o sprite na posição indicada
+ */
+void tft_sprite_show(tft_sprite_t *s, int16_t x, int16_t y)
+{
+	if (s->visible)
+		tft_sprite_hide(s);
+	s->x = x;
+	s->y = y;
+	sprite_save(s, x, y, s->w, s->h);
+	sprite_write(s, x, y, s->w, s->h, 1);
+	s->visible = 1;
+}
+
+/**
+ * @brief Move o sprite repintando só a área descoberta e a nova posição
+ */
+void tft_sprite_moveTo(tft_sprite_t *s, int16_t x, int16_t y)
+{
+	int16_t dx = x - s->x, dy = y - s->y;
+	int16_t w = s->w, h = s->h;
+
+	if (!s->visible) {
+		tft_sprite_show(s, x, y);
+		return;
+	}
+	if (!dx && !dy)
+		return;
+	if (dx >= w || -dx >= w || dy >= h || -dy >= h) {
+		//sem sobreposição: restaura tudo e desenha na nova posição
+		tft_sprite_show(s, x, y);
+		return;
+	}
+
+	//Restaura a parte da posição antiga que fica descoberta (formato "L")
+	int16_t oh = h - ((dy < 0) ? -dy : dy);
+	int16_t oy = (dy > 0) ? s->y + dy : s->y;
+	if (dy > 0)
+		sprite_write(s, s->x, s->y, w, dy, 0);
+	else if (dy < 0)
+		sprite_write(s, s->x, s->y + h + dy, w, -dy, 0);
+	if (dx > 0)
+		sprite_write(s, s->x, oy, dx, oh, 0);
+	else if (dx < 0)
+		sprite_write(s, s->x + w + dx, oy, -dx, oh, 0);
+
+	s->x = x;
+	s->y = y;
+	if (s->background) {
+		//A parte comum já está no buffer, lê da GRAM apenas a faixa nova
+		sprite_shift(s, dx, dy);
+		int16_t ny = (dy > 0) ? y : y - dy;
+		if (dy > 0)
+			sprite_save(s, x, y + h - dy, w, dy);
+		else if (dy < 0)
+			sprite_save(s, x, y, w, -dy);
+		if (dx > 0)
+			sprite_save(s, x + w - dx, ny, dx, oh);
+		else if (dx < 0)
+			sprite_save(s, x, ny, -dx, oh);
+	}
+	sprite_write(s, x, y, w, h, 1);
+}
+
+/**
+ * @brief Troca a imagem (quadro de animação do mesmo tamanho) e redesenha no lugar
+ */
+void tft_sprite_setImage(tft_sprite_t *s, const void *pixels)
+{
+	s->pixels = pixels;
+	if (s->visible)
+		sprite_write(s, s->x, s->y, s->w, s->h, 1);
+}
+
+/**
+ * @brief Apaga o sprite restaurando o fundo
+ */
+void tft_sprite_hide(tft_sprite_t *s)
+{
+	if (!s->visible)
+		return;
+	sprite_write(s, s->x, s->y, s->w, s->h, 0);
+	s->visible = 0;
+}
@@ -0,0 +1,221 @@
+/**
+ ******************************************************************************
+ * @file    tft_tilecache.c
+ * @brief   Cache LRU em RAM de regiões já decodificadas dos recursos.
+ ******************************************************************************
+ * @attention
+ *
+ * As regiões ficam contíguas na área, na ordem das entradas; ao descartar
+ * uma, as seguintes são movidas para baixo, então nunca há fragmentação e
+ * o espaço livre está sempre no fim. Isso só acontece em uma falta, que
+ * já paga a decodificação. A busca é linear sobre poucas entradas.
+ * Depois de tft_assets_mount() com outro pacote, chame tft_tile_flush().
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_tilecache.h"
+
+/* Tipos --------------------------------------------------------------------*/
+typedef struct {
+	uint32_t id;
+	int16_t sx, sy, w, h;
+	uint32_t offset;			//início na área, em pixels
+	uint32_t size;				//pixels ocupados (par, mantém o alinhamento de 4 bytes)
+	uint32_t used;				//instante do último uso
+} tile_t;
+
+/* Variáveis privadas -------------------------------------------------------*/
+static uint16_t arena[TFT_TILECACHE_BYTES / sizeof(uint16_t)] __attribute__((aligned(4)));
+static tile_t tiles[TFT_TILECACHE_SLOTS];
+static uint8_t ntiles;
+static uint32_t top;			//pixels em uso na área
+static uint32_t now;
+static tft_tilestats_t stats;
+
+/* Funções privadas ---------------------------------------------------------*/
+/**
+ * @brief Descarta a entrada i e compacta a área
+ */
+static void evict(uint8_t i)
+{
+	uint32_t size = tiles[i].size, end = tiles[i].offset + size;
+
+	memmove(&arena[tiles[i].offset], &arena[end], (top - end) * sizeof(uint16_t));
+	top -= size;
+	for (uint8_t j = i + 1; j < ntiles; j++) {
+		tiles[j].offset -= size;
+		tiles[j - 1] = tiles[j];
+	}
+	ntiles--;
+	stats.evictions++;
+}
+
+/**
+ * @brief Descarta a entrada usada há mais tempo
+ */
+static void evictOldest(void)
+{
+	uint8_t old = 0;
+
+	for (uint8_t i = 1; i < ntiles; i++)
+		if (now - tiles[i].used > now - tiles[old].used)
+			old = i;
+	evict(old);
+}
+
+/**
+ * @brief Envia w x h pixels contíguos da RAM para o LCD, recortados pela tela
+ */
+static void blit(int16_t x, int16_t y, const uint16_t *px, int16_t w, int16_t h)
+{
+	int16_t x0 = 0, y0 = 0, stride = w;
+
+	if (x < 0) { x0 = -x; w += x; x = 0; }
+	if (y < 0) { y0 = -y; h += y; y = 0; }
+	if (x + w > tft_width()) w = tft_width() - x;
+	if (y + h > tft_height()) h = tft_height() - y;
+	if (w <= 0 || h <= 0)
+		return;
+	px += (int32_t)y0 * stride + x0;
+	const tft_target_t *t = tft_getTarget();
+	if (t) {
+		for (int16_t r = 0; r < h; r++, px += stride)
+			t->writeRect(x, y + r, w, 1, px);
+		return;
+	}
+	tft_startWrite(x, y, w, h);
+	if (w == stride) {
+		tft_writeColors(px, (uint32_t)w * h);
+	} else {
+		for (int16_t r = 0; r < h; r++, px += stride)
+			tft_writeColors(px, w);
+	}
+	tft_endWrite();
+}
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Retorna os pixels de uma região do recurso, decodificando se necessário
+ * @details O ponteiro vale até a próxima falta no cache (a área é compactada),
+ * por exemplo para usar a região como camada de tft_compose no mesmo quadro.
+ *
+ * @param a recurso de imagem (tft_asset_find()/tft_asset_findName())
+ * @param sx,sy canto da região dentro da imagem
+ * @param w,h tamanho da região
+ * @return w*h pixels RGB565 na RAM ou NULL se a região é inválida, não cabe
+ * no cache ou a decodificação falhou
+ */
+const uint16_t *tft_tile_get(const tft_asset_t *a, int16_t sx, int16_t sy, int16_t w, int16_t h)
+{
+	if (!a || w <= 0 || h <= 0 || sx < 0 || sy < 0 || sx + w > a->w || sy + h > a->h)
+		return NULL;
+
+	now++;
+	for (uint8_t i = 0; i < ntiles; i++) {
+		tile_t *t = &tiles[i];
+		if (t->id == a->id && t->sx == sx && t->sy == sy && t->w == w && t->h == h) {
+			t->used = now;
+			stats.hits++;
+			return &arena[t->offset];
+		}
+	}
+
+	uint32_t size = ((uint32_t)w * h + 1) & ~1u;
+	if (size > sizeof(arena) / sizeof(uint16_t) || w > tft_width() || h > tft_height())
+		return NULL;
+	stats.misses++;
+	while (ntiles && (ntiles == TFT_TILECACHE_SLOTS || top + size > sizeof(arena) / sizeof(uint16_t)))
+		evictOldest();
+
+	/* decodifica com a região em (0, 0) de uma tela virtual de w x h; um alvo
+	 * instalado desviaria os decodificadores da captura, então fica suspenso */
+	uint16_t *px = &arena[top];
+	const tft_target_t *target = tft_getTarget();
+	tft_setTarget(NULL);
+	tft_setCapture(px, w, h);
+	int8_t err = tft_asset_draw(-sx, -sy, a);
+	tft_setCapture(NULL, 0, 0);
+	tft_setTarget(target);
+	if (err)
+		return NULL;
+
+	tile_t *t = &tiles[ntiles++];
+	t->id = a->id;
+	t->sx = sx;
+	t->sy = sy;
+	t->w = w;
+	t->h = h;
+	t->offset = top;
+	t->size = size;
+	t->used = now;
+	top += size;
+	return px;
+}
+
+/**
+ * @brief Desenha uma região de um recurso a partir do cache
+ *
+ * @param x,y posição na tela (pode estar parcialmente fora)
+ * @param a recurso de imagem
+ * @param sx,sy canto da região dentro da imagem
+ * @param w,h tamanho da região
+ * @return 0 ou -1 se a região não pôde ser obtida (ver tft_tile_get())
+ */
+int8_t tft_tile_draw(int16_t x, int16_t y, const tft_asset_t *a, int16_t sx, int16_t sy, int16_t w, int16_t h)
+{
+	const uint16_t *px = tft_tile_get(a, sx, sy, w, h);
+
+	if (!px)
+		return -1;
+	blit(x, y, px, w, h);
+	return 0;
+}
+
+/**
+ * @brief Desenha um recurso inteiro a partir do cache
+ * @details Imagens RGB565 cruas já estão prontas na flash e imagens que não cabem
+ * no cache são desenhadas direto por tft_asset_draw(), sem passar pelo cache.
+ *
+ * @param x,y posição na tela
+ * @param a recurso de imagem
+ * @return 0 ou -1 se o recurso não é uma imagem válida
+ */
+int8_t tft_tile_drawAsset(int16_t x, int16_t y, const tft_asset_t *a)
+{
+	if (!a)
+		return -1;
+	if (a->format != TFT_ASSET_RGB565 && !tft_tile_draw(x, y, a, 0, 0, a->w, a->h))
+		return 0;
+	return tft_asset_draw(x, y, a);
+}
+
+/**
+ * @brief Esvazia o cache (por exemplo depois de trocar o pacote de recursos)
+ */
+void tft_tile_flush(void)
+{
+	ntiles = 0;
+	top = 0;
+}
+
+/**
+ * @brief Estatísticas de uso do cache
+ *
+ * @param s preenchida com acertos, faltas, descartes e ocupação
+ */
+void tft_tile_stats(tft_tilestats_t *s)
+{
+	*s = stats;
+	s->bytes = top * sizeof(uint16_t);
+	s->tiles = ntiles;
+}
+
+/**
+ * @brief Zera os contadores de acertos, faltas e descartes
+ */
+void tft_tile_resetStats(void)
+{
+	stats.hits = stats.misses = stats.evictions = 0;
+}
@@ -0,0 +1,269 @@
+/**
+ ******************************************************************************
+ * @file    tft_tilemap.c
+ * @brief   Fundo formado por blocos (tile map) com redesenho seletivo.
+ ******************************************************************************
+ * @attention
+ *
+ * Em cada linha do mapa as células alteradas consecutivas formam uma única
+ * janela; cada linha de pixels da janela é montada bloco a bloco, vindo do
+ * cache (RGB565) ou expandida pela paleta direto no barramento.
+ * O cache guarda os blocos mais frequentes: cada bloco fora do cache soma
+ * pontos quando é desenhado e toma o lugar do bloco em cache com menos
+ * pontos quando os supera; o bloco que resiste perde um ponto, então blocos
+ * que deixam de ser usados acabam saindo. As entradas usadas pela sequência
+ * em desenho ficam presas até o fim dela, para que um bloco mais adiante não
+ * sobrescreva os pixels de um anterior que ainda vai ser enviado.
+ * As células parcialmente visíveis são recortadas pela tela; as que estão
+ * inteiramente fora continuam marcadas até ficarem visíveis.
+ ******************************************************************************
+ */
+
+/* Includes -----------------------------------------------------------------*/
+#include "tft_tilemap.h"
+
+/* Contantes e macros -------------------------------------------------------*/
+#define TILEMAP_LINE_MAX	((WIDTH > HEIGHT) ? WIDTH : HEIGHT)
+#define TILEMAP_RUN_MAX		(TILEMAP_LINE_MAX / 8)
+
+/* Tipos --------------------------------------------------------------------*/
+#if TFT_TILEMAP_CACHE > 0
+typedef struct {
+	const uint8_t *tiles;
+	const uint16_t *palette;
+	uint8_t id;
+	uint8_t valid;
+	uint8_t uses;
+	uint8_t pinned;			//em uso pela sequência sendo desenhada
+	uint16_t pixels[TFT_TILEMAP_TILE_MAX * TFT_TILEMAP_TILE_MAX];
+} tile_slot_t;
+#endif
+
+/* Variáveis privadas -------------------------------------------------------*/
+#if TFT_TILEMAP_CACHE > 0
+static tile_slot_t tile_cache[TFT_TILEMAP_CACHE];
+static uint8_t tile_uses[256];
+#endif
+static uint32_t tile_hits, tile_misses;
+static uint16_t tile_line[TILEMAP_LINE_MAX];
+
+/* Funções privadas ---------------------------------------------------------*/
+static uint8_t is_dirty(const tft_tilemap_t *m, uint32_t cell)
+{
+	return (m->dirty[cell >> 3] >> (cell & 7)) & 1;
+}
+
+/**
+ * @brief Procura o bloco no cache, possivelmente colocando-o lá
+ *
+ * @return pixels RGB565 do bloco ou NULL se ele não está no cache
+ */
+static const uint16_t *tile_lookup(const tft_tilemap_t *m, uint8_t id)
+{
+#if TFT_TILEMAP_CACHE > 0
+	tile_slot_t *victim = NULL;
+
+	for (uint8_t i = 0; i < TFT_TILEMAP_CACHE; i++) {
+		tile_slot_t *slot = &tile_cache[i];
+		if (slot->valid && slot->id == id && slot->tiles == m->tiles && slot->palette == m->palette) {
+			if (slot->uses < 255) slot->uses++;
+			slot->pinned = 1;
+			tile_hits++;
+			return slot->pixels;
+		}
+		if (slot->pinned)
+			continue;
+		if (!victim || !slot->valid || (victim->valid && slot->uses < victim->uses))
+			victim = slot;
+	}
+	tile_misses++;
+	if (m->tw > TFT_TILEMAP_TILE_MAX || m->th > TFT_TILEMAP_TILE_MAX)
+		return NULL;
+	if (tile_uses[id] < 255) tile_uses[id]++;
+	if (!victim)
+		return NULL;
+	if (victim->valid && tile_uses[id] <= victim->uses) {
+		victim->uses--;
+		return NULL;
+	}
+	const uint8_t *src = &m->tiles[(uint32_t)id * m->tw * m->th];
+	for (uint16_t i = 0; i < m->tw * m->th; i++)
+		victim->pixels[i] = m->palette[src[i]];
+	victim->tiles = m->tiles;
+	victim->palette = m->palette;
+	victim->id = id;
+	victim->uses = tile_uses[id];
+	victim->valid = 1;
+	victim->pinned = 1;
+	tile_uses[id] = 0;
+	return victim->pixels;
+#else
+	tile_misses++;
+	return NULL;
+#endif
+}
+
+/**
+ * @brief Libera as entradas do cache presas pela sequência desenhada
+ */
+static void tile_unpin(void)
+{
+#if TFT_TILEMAP_CACHE > 0
+	for (uint8_t i = 0; i < TFT_TILEMAP_CACHE; i++)
+		tile_cache[i].pinned = 0;
+#endif
+}
+
+/**
+ * @brief Desenha n células consecutivas de uma linha do mapa em uma janela
+ * @details A janela é recortada pela tela; só a primeira e a última célula da
+ * sequência podem estar parcialmente fora dela.
+ */
+static void tilemap_run(const tft_tilemap_t *m, uint16_t row, uint16_t col, uint8_t n)
+{
+	const uint8_t *src[TILEMAP_RUN_MAX];
+	const uint16_t *cached[TILEMAP_RUN_MAX];
+	const tft_target_t *t = tft_getTarget();
+	int16_t x = m->x + col * m->tw, y = m->y + row * m->th, w = n * m->tw, h = m->th;
+	uint16_t tile_size = m->tw * m->th;
+	int16_t left = 0, top = 0, right = 0;
+
+	if (x < 0) { left = -x; w += x; x = 0; }
+	if (y < 0) { top = -y; h += y; y = 0; }
+	if (x + w > tft_width()) { right = x + w - tft_width(); w = tft_width() - x; }
+	if (y + h > tft_height()) h = tft_height() - y;
+	if (w <= 0 || h <= 0)
+		return;
+	for (uint8_t k = 0; k < n; k++) {
+		uint8_t id = m->map[(uint32_t)row * m->cols + col + k];
+		src[k] = &m->tiles[(uint32_t)id * tile_size];
+		cached[k] = tile_lookup(m, id);
+	}
+	if (!t)
+		tft_startWrite(x, y, w, h);
+	for (int16_t py = top; py < top + h; py++) {
+		uint16_t offset = py * m->tw;
+		uint16_t *p = tile_line;
+		for (uint8_t k = 0; k < n; k++) {
+			/* colunas visíveis do bloco k */
+			int16_t x0 = (k == 0) ? left : 0;
+			int16_t x1 = (k == n - 1) ? m->tw - right : m->tw;
+			if (x0 >= x1)
+				continue;
+			if (t) {
+				for (int16_t px = x0; px < x1; px++)
+					*p++ = cached[k] ? cached[k][offset + px] : m->palette[src[k][offset + px]];
+			} else if (cached[k]) {
+				tft_writeColors(&cached[k][offset + x0], x1 - x0);
+			} else {
+				tft_writeIndexed8(&src[k][offset + x0], m->palette, x1 - x0);
+			}
+		}
+		if (t)
+			t->writeRect(x, y + py - top, w, 1, tile_line);
+	}
+	if (!t)
+		tft_endWrite();
+	tile_unpin();
+}
+
+/* Funções públicas ---------------------------------------------------------*/
+
+/**
+ * @brief Prepara um mapa e marca todas as células para redesenho
+ *
+ * @param m mapa
+ * @param tiles blocos em flash (tw*th índices de 8 bits cada)
+ * @param palette paleta RGB565
+ * @param tw largura de um bloco
+ * @param th altura de um bloco
+ * @param map vetor de cols*rows números de bloco
+ * @param dirty vetor de (cols*rows+7)/8 bytes para as marcas de alteração
+ * @param cols colunas do mapa
+ * @param rows linhas do mapa
+ * @param x coluna da tela do canto superior esquerdo do mapa
+ * @param y linha da tela do canto superior esquerdo do mapa
+ */
+void tft_tilemap_init(tft_tilemap_t *m, const uint8_t *tiles, const uint16_t *palette, uint8_t tw, uint8_t th,
+		uint8_t *map, uint8_t *dirty, uint16_t cols, uint16_t rows, int16_t x, int16_t y)
+{
+	m->tiles = tiles;
+	m->palette = palette;
+	m->tw = tw;
+	m->th = th;
+	m->map = map;
+	m->dirty = dirty;
+	m->cols = cols;
+	m->rows = rows;
+	m->x = x;
+	m->y = y;
+	tft_tilemap_invalidate(m, 0, 0, cols, rows);
+}
+
+/**
+ * @brief Troca o bloco de uma célula, marcando-a apenas se mudou
+ */
+void tft_tilemap_set(tft_tilemap_t *m, uint16_t col, uint16_t row, uint8_t tile)
+{
+	uint32_t cell = (uint32_t)row * m->cols + col;
+
+	if (col >= m->cols || row >= m->rows || m->map[cell] == tile)
+		return;
+	m->map[cell] = tile;
+	m->dirty[cell >> 3] |= 1 << (cell & 7);
+}
+
+/**
+ * @brief Marca um bloco de células para redesenho (ex.: algo foi desenhado por cima)
+ */
+void tft_tilemap_invalidate(tft_tilemap_t *m, uint16_t col, uint16_t row, uint16_t ncols, uint16_t nrows)
+{
+	for (uint16_t r = row; r < row + nrows && r < m->rows; r++)
+		for (uint16_t c = col; c < col + ncols && c < m->cols; c++) {
+			uint32_t cell = (uint32_t)r * m->cols + c;
+			m->dirty[cell >> 3] |= 1 << (cell & 7);
+		}
+}
+
+/**
+ * @brief Redesenha as células alteradas
+ * @details Só as células ao menos em parte visíveis são desenhadas e têm a marca
+ * apagada; as que estão fora da tela continuam marcadas.
+ */
+void tft_tilemap_draw(tft_tilemap_t *m)
+{
+	/* faixa de células visíveis */
+	int16_t c0 = (m->x < 0) ? -m->x / m->tw : 0, r0 = (m->y < 0) ? -m->y / m->th : 0;
+	int32_t c1 = (tft_width() - m->x + m->tw - 1) / m->tw, r1 = (tft_height() - m->y + m->th - 1) / m->th;
+
+	if (c1 > m->cols) c1 = m->cols;
+	if (r1 > m->rows) r1 = m->rows;
+	for (int32_t row = r0; row < r1; row++) {
+		int32_t col = c0;
+		while (col < c1) {
+			uint32_t cell = (uint32_t)row * m->cols + col;
+			if (!is_dirty(m, cell)) {
+				col++;
+				continue;
+			}
+			uint16_t start = col;
+			uint8_t n = 0;
+			while (col < c1 && n < TILEMAP_RUN_MAX && is_dirty(m, cell)) {
+				m->dirty[cell >> 3] &= ~(1 << (cell & 7));
+				col++;
+				cell++;
+				n++;
+			}
+			tilemap_run(m, row, start, n);
+		}
+	}
+}
+
+/**
+ * @brief Acertos e faltas do cache de blocos desde o início
+ */
+void tft_tilemap_cacheStats(uint32_t *hits, uint32_t *misses)
+{
+	if (hits) *hits = tile_hits;
+	if (misses) *misses = tile_misses;
+}
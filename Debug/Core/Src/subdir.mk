@@ -12,7 +12,21 @@ C_SRCS += \
 ../Core/Src/syscalls.c \
 ../Core/Src/sysmem.c \
 ../Core/Src/system_stm32f4xx.c \
-../Core/Src/tft.c 
+../Core/Src/tft.c \
+../Core/Src/tft_alpha.c \
+../Core/Src/tft_anim.c \
+../Core/Src/tft_assets.c \
+../Core/Src/tft_compose.c \
+../Core/Src/tft_damage.c \
+../Core/Src/tft_dlist.c \
+../Core/Src/tft_fb.c \
+../Core/Src/tft_image.c \
+../Core/Src/tft_jpeg.c \
+../Core/Src/tft_pipe.c \
+../Core/Src/tft_pixconv.c \
+../Core/Src/tft_sprite.c \
+../Core/Src/tft_tilecache.c \
+../Core/Src/tft_tilemap.c 
 
 OBJS += \
 ./Core/Src/fonts.o \
@@ -22,7 +36,21 @@ OBJS += \
 ./Core/Src/syscalls.o \
 ./Core/Src/sysmem.o \
 ./Core/Src/system_stm32f4xx.o \
-./Core/Src/tft.o 
+./Core/Src/tft.o \
+./Core/Src/tft_alpha.o \
+./Core/Src/tft_anim.o \
+./Core/Src/tft_assets.o \
+./Core/Src/tft_compose.o \
+./Core/Src/tft_damage.o \
+./Core/Src/tft_dlist.o \
+./Core/Src/tft_fb.o \
+./Core/Src/tft_image.o \
+./Core/Src/tft_jpeg.o \
+./Core/Src/tft_pipe.o \
+./Core/Src/tft_pixconv.o \
+./Core/Src/tft_sprite.o \
+./Core/Src/tft_tilecache.o \
+./Core/Src/tft_tilemap.o 
 
 C_DEPS += \
 ./Core/Src/fonts.d \
@@ -32,7 +60,21 @@ C_DEPS += \
 ./Core/Src/syscalls.d \
 ./Core/Src/sysmem.d \
 ./Core/Src/system_stm32f4xx.d \
-./Core/Src/tft.d 
+./Core/Src/tft.d \
+./Core/Src/tft_alpha.d \
+./Core/Src/tft_anim.d \
+./Core/Src/tft_assets.d \
+./Core/Src/tft_compose.d \
+./Core/Src/tft_damage.d \
+./Core/Src/tft_dlist.d \
+./Core/Src/tft_fb.d \
+./Core/Src/tft_image.d \
+./Core/Src/tft_jpeg.d \
+./Core/Src/tft_pipe.d \
+./Core/Src/tft_pixconv.d \
+./Core/Src/tft_sprite.d \
+./Core/Src/tft_tilecache.d \
+./Core/Src/tft_tilemap.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -42,7 +84,7 @@ Core/Src/%.o Core/Src/%.su Core/Src/%.cyclo: ../Core/Src/%.c Core/Src/subdir.mk
 clean: clean-Core-2f-Src
 
 clean-Core-2f-Src:
-	-$(RM) ./Core/Src/fonts.cyclo ./Core/Src/fonts.d ./Core/Src/fonts.o ./Core/Src/fonts.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su ./Core/Src/tft.cyclo ./Core/Src/tft.d ./Core/Src/tft.o ./Core/Src/tft.su
+	-$(RM) ./Core/Src/fonts.cyclo ./Core/Src/fonts.d ./Core/Src/fonts.o ./Core/Src/fonts.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su ./Core/Src/tft.cyclo ./Core/Src/tft.d ./Core/Src/tft.o ./Core/Src/tft.su ./Core/Src/tft_alpha.cyclo ./Core/Src/tft_alpha.d ./Core/Src/tft_alpha.o ./Core/Src/tft_alpha.su ./Core/Src/tft_anim.cyclo ./Core/Src/tft_anim.d ./Core/Src/tft_anim.o ./Core/Src/tft_anim.su ./Core/Src/tft_assets.cyclo ./Core/Src/tft_assets.d ./Core/Src/tft_assets.o ./Core/Src/tft_assets.su ./Core/Src/tft_compose.cyclo ./Core/Src/tft_compose.d ./Core/Src/tft_compose.o ./Core/Src/tft_compose.su ./Core/Src/tft_damage.cyclo ./Core/Src/tft_damage.d ./Core/Src/tft_damage.o ./Core/Src/tft_damage.su ./Core/Src/tft_dlist.cyclo ./Core/Src/tft_dlist.d ./Core/Src/tft_dlist.o ./Core/Src/tft_dlist.su ./Core/Src/tft_fb.cyclo ./Core/Src/tft_fb.d ./Core/Src/tft_fb.o ./Core/Src/tft_fb.su ./Core/Src/tft_image.cyclo ./Core/Src/tft_image.d ./Core/Src/tft_image.o ./Core/Src/tft_image.su ./Core/Src/tft_jpeg.cyclo ./Core/Src/tft_jpeg.d ./Core/Src/tft_jpeg.o ./Core/Src/tft_jpeg.su ./Core/Src/tft_pipe.cyclo ./Core/Src/tft_pipe.d ./Core/Src/tft_pipe.o ./Core/Src/tft_pipe.su ./Core/Src/tft_pixconv.cyclo ./Core/Src/tft_pixconv.d ./Core/Src/tft_pixconv.o ./Core/Src/tft_pixconv.su ./Core/Src/tft_sprite.cyclo ./Core/Src/tft_sprite.d ./Core/Src/tft_sprite.o ./Core/Src/tft_sprite.su ./Core/Src/tft_tilecache.cyclo ./Core/Src/tft_tilecache.d ./Core/Src/tft_tilecache.o ./Core/Src/tft_tilecache.su ./Core/Src/tft_tilemap.cyclo ./Core/Src/tft_tilemap.d ./Core/Src/tft_tilemap.o ./Core/Src/tft_tilemap.su
 
 .PHONY: clean-Core-2f-Src
 
@@ -0,0 +1,188 @@
+/**
+ ******************************************************************************
+ * @file    anim_encode.c
+ * @brief   Gera animações para tft_anim a partir de quadros RGB565 crus.
+ ******************************************************************************
+ * @attention
+ *
+ * Ferramenta de PC (não faz parte do firmware):
+ *   gcc -O2 -o anim_encode anim_encode.c
+ *   anim_encode [-l] nome w h ms quadro0.raw quadro1.raw ... > nome.c
+ * Cada arquivo tem w*h pixels RGB565 little-endian. Com -l é gravado um
+ * quadro extra que volta ao primeiro, para reprodução em laço.
+ * As linhas alteradas consecutivas (tolerando ANIM_GAP linhas iguais) são
+ * agrupadas em um retângulo com a união das colunas alteradas.
+ ******************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ANIM_MAGIC	0x4E41
+#define ANIM_LOOP	0x0001
+#define ANIM_RUN	0x8000
+#define ANIM_GAP	2		//linhas iguais toleradas dentro de um retângulo
+#define RUN_MIN		3		//repetições menores viram literais
+
+static uint16_t *out;
+static size_t out_n, out_cap;
+static int width, height;
+
+static void emit(uint16_t v)
+{
+	if (out_n == out_cap) {
+		out_cap = out_cap ? out_cap * 2 : 4096;
+		out = realloc(out, out_cap * sizeof(uint16_t));
+		if (!out) {
+			perror("realloc");
+			exit(1);
+		}
+	}
+	out[out_n++] = v;
+}
+
+static void emit_rect(const uint16_t *img, int x, int y, int w, int h)
+{
+	emit(x); emit(y); emit(w); emit(h);
+	size_t n = (size_t)w * h, i = 0;
+	uint16_t *px = malloc(n * sizeof(uint16_t));
+	for (int r = 0; r < h; r++)
+		memcpy(&px[(size_t)r * w], &img[(size_t)(y + r) * width + x], w * sizeof(uint16_t));
+
+	while (i < n) {
+		size_t run = 1;
+		while (i + run < n && px[i + run] == px[i] && run < 0x8000)
+			run++;
+		if (run >= RUN_MIN) {
+			emit(ANIM_RUN | (run - 1));
+			emit(px[i]);
+			i += run;
+			continue;
+		}
+		/* literais até o início da próxima repetição */
+		size_t lit = 0;
+		while (i + lit < n && lit < 0x8000) {
+			if (i + lit + RUN_MIN <= n && px[i + lit] == px[i + lit + 1] && px[i + lit] == px[i + lit + 2])
+				break;
+			lit++;
+		}
+		emit(lit - 1);
+		for (size_t k = 0; k < lit; k++)
+			emit(px[i + k]);
+		i += lit;
+	}
+	free(px);
+}
+
+/**
+ * @brief Codifica a passagem de prev para cur (prev NULL gera quadro completo)
+ */
+static void emit_frame(const uint16_t *prev, const uint16_t *cur)
+{
+	size_t count_at = out_n;
+	uint16_t count = 0;
+
+	emit(0);
+	if (!prev) {
+		emit_rect(cur, 0, 0, width, height);
+		out[count_at] = 1;
+		return;
+	}
+	int y = 0;
+	while (y < height) {
+		int x0 = width, x1 = -1, y0 = -1, y1 = -1, gap = 0;
+		for (; y < height; y++) {
+			const uint16_t *a = &prev[(size_t)y * width], *b = &cur[(size_t)y * width];
+			int l = 0, r = width - 1;
+			while (l < width && a[l] == b[l])
+				l++;
+			if (l == width) {
+				if (y0 >= 0 && ++gap > ANIM_GAP)
+					break;
+				continue;
+			}
+			while (a[r] == b[r])
+				r--;
+			if (y0 < 0)
+				y0 = y;
+			y1 = y;
+			gap = 0;
+			if (l < x0) x0 = l;
+			if (r > x1) x1 = r;
+		}
+		if (y0 < 0)
+			break;
+		emit_rect(cur, x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+		count++;
+	}
+	out[count_at] = count;
+}
+
+static uint16_t *load(const char *path)
+{
+	size_t n = (size_t)width * height;
+	uint16_t *img = malloc(n * sizeof(uint16_t));
+	uint8_t *raw = malloc(n * 2);
+	FILE *f = fopen(path, "rb");
+
+	if (!f || fread(raw, 2, n, f) != n) {
+		fprintf(stderr, "%s: esperado %dx%d pixels RGB565\n", path, width, height);
+		exit(1);
+	}
+	fclose(f);
+	for (size_t i = 0; i < n; i++)
+		img[i] = raw[2 * i] | (raw[2 * i + 1] << 8);
+	free(raw);
+	return img;
+}
+
+int main(int argc, char **argv)
+{
+	int loop = 0, arg = 1;
+
+	if (argc > 1 && !strcmp(argv[1], "-l")) {
+		loop = 1;
+		arg++;
+	}
+	if (argc - arg < 5) {
+		fprintf(stderr, "uso: %s [-l] nome w h ms quadro0.raw [quadro1.raw ...]\n", argv[0]);
+		return 1;
+	}
+	const char *name = argv[arg];
+	width = atoi(argv[arg + 1]);
+	height = atoi(argv[arg + 2]);
+	int ms = atoi(argv[arg + 3]);
+	int nframes = argc - arg - 4;
+	char **files = &argv[arg + 4];
+	if (width <= 0 || height <= 0 || width > 0x7FFF || height > 0x7FFF) {
+		fprintf(stderr, "dimensões inválidas\n");
+		return 1;
+	}
+	if (nframes < 2)
+		loop = 0;
+
+	uint16_t *first = load(files[0]), *prev = NULL, *cur = first;
+	emit(ANIM_MAGIC); emit(width); emit(height);
+	emit(nframes + loop); emit(ms); emit(loop ? ANIM_LOOP : 0);
+	for (int i = 0; i < nframes; i++) {
+		if (i)
+			cur = load(files[i]);
+		emit_frame(prev, cur);
+		if (prev && prev != first)
+			free(prev);
+		prev = cur;
+	}
+	if (loop)
+		emit_frame(prev, first);
+
+	size_t raw = (size_t)width * height * nframes * 2;
+	printf("/* %s: %dx%d, %d quadros, %d ms; %zu bytes (%zu em quadros crus) */\n",
+			name, width, height, nframes, ms, out_n * 2, raw);
+	printf("#include <stdint.h>\n\nconst uint16_t %s[%zu] = {", name, out_n);
+	for (size_t i = 0; i < out_n; i++)
+		printf("%s0x%04X,", (i % 12) ? " " : "\n\t", out[i]);
+	printf("\n};\n");
+	return 0;
+}
@@ -0,0 +1,327 @@
+/**
+ ******************************************************************************
+ * @file    asset_pack.c
+ * @brief   Monta o pacote de recursos lido por tft_assets.
+ ******************************************************************************
+ * @attention
+ *
+ * Ferramenta de PC (não faz parte do firmware):
+ *   gcc -O2 -o asset_pack asset_pack.c
+ *   asset_pack saida.bin|saida.c nome=formato:arquivo[:w:h] ...
+ * Formatos:
+ *   rgb565  pixels RGB565 little-endian crus (w e h obrigatórios)
+ *   rle     saída de "img_encode -b rle"
+ *   qoi     saída de "img_encode -b qoi"
+ *   jpeg    arquivo .jpg baseline
+ *   font    fonte GFX no formato .h do fontconvert (como em fonts.c)
+ * Com saida.bin o pacote é gravado no setor ASSETS separadamente, por
+ * exemplo: st-flash write saida.bin 0x08060000. Com saida.c é gerado um
+ * vetor na seção .assets, ligado junto com o firmware.
+ ******************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+
+#define PACK_MAGIC		0x4B415054
+#define PACK_VERSION	1
+#define PACK_HEADER		16
+#define PACK_ENTRY		32
+#define NAME_MAX_LEN	11
+
+enum { F_RGB565 = 1, F_RLE, F_QOI, F_JPEG, F_FONT };
+
+typedef struct {
+	uint32_t id, offset, size;
+	uint16_t format, w, h;
+	char name[NAME_MAX_LEN + 1];
+	uint8_t *data;
+} entry_t;
+
+static uint32_t hash(const char *name)
+{
+	uint32_t h = 2166136261u;
+
+	for (int i = 0; name[i] && i < NAME_MAX_LEN; i++) {
+		h ^= (uint8_t)name[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static uint8_t *load(const char *path, uint32_t *size)
+{
+	FILE *f = fopen(path, "rb");
+	uint8_t *buf;
+	long n;
+
+	if (!f) {
+		perror(path);
+		exit(1);
+	}
+	fseek(f, 0, SEEK_END);
+	n = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	buf = malloc(n + 1);
+	if (fread(buf, 1, n, f) != (size_t)n) {
+		perror(path);
+		exit(1);
+	}
+	fclose(f);
+	buf[n] = 0;
+	*size = n;
+	return buf;
+}
+
+/**
+ * @brief Dimensões do SOF de um JPEG
+ */
+static int jpeg_size(const uint8_t *d, uint32_t n, uint16_t *w, uint16_t *h)
+{
+	uint32_t p = 2;
+
+	if (n < 4 || d[0] != 0xFF || d[1] != 0xD8)
+		return -1;
+	while (p + 9 < n && d[p] == 0xFF) {
+		uint8_t m = d[p + 1];
+		uint16_t len = (d[p + 2] << 8) | d[p + 3];
+		if (m >= 0xC0 && m <= 0xCF && m != 0xC4 && m != 0xC8 && m != 0xCC) {
+			*h = (d[p + 5] << 8) | d[p + 6];
+			*w = (d[p + 7] << 8) | d[p + 8];
+			return 0;
+		}
+		p += 2 + len;
+	}
+	return -1;
+}
+
+/**
+ * @brief Lê os números de um bloco "{ ... };" a partir de *pos, sem comentários
+ */
+static long *numbers(const char **pos, size_t *count)
+{
+	const char *p = strchr(*pos, '{'), *end;
+	size_t cap = 1024, n = 0;
+	long *v = malloc(cap * sizeof(long));
+
+	if (!p)
+		return NULL;
+	end = strstr(p, "};");
+	if (!end)
+		return NULL;
+	while (p < end) {
+		if (isdigit((unsigned char)*p) || (*p == '-' && isdigit((unsigned char)p[1]))) {
+			char *q;
+			if (n == cap)
+				v = realloc(v, (cap *= 2) * sizeof(long));
+			v[n++] = strtol(p, &q, 0);
+			p = q;
+		} else if (isalpha((unsigned char)*p) || *p == '_') {
+			/* identificadores (podem ter dígitos) */
+			while (p < end && (isalnum((unsigned char)*p) || *p == '_'))
+				p++;
+		} else if (*p == '(') {
+			/* conversões de tipo como (uint8_t *) */
+			while (p < end && *p != ')')
+				p++;
+		} else {
+			p++;
+		}
+	}
+	*pos = end + 2;
+	*count = n;
+	return v;
+}
+
+/**
+ * @brief Converte uma fonte GFX em C (fontconvert) para o formato do pacote
+ */
+static uint8_t *font_blob(char *src, uint32_t *size)
+{
+	/* remove comentários */
+	for (char *p = src; *p; p++) {
+		if (p[0] == '/' && p[1] == '/') {
+			while (*p && *p != '\n')
+				*p++ = ' ';
+		} else if (p[0] == '/' && p[1] == '*') {
+			while (*p && !(p[0] == '*' && p[1] == '/'))
+				*p++ = ' ';
+			if (*p) {
+				p[0] = p[1] = ' ';
+			}
+		}
+	}
+
+	const char *pos = strstr(src, "Bitmaps");
+	size_t nb, ng, nf;
+	long *bm = pos ? numbers(&pos, &nb) : NULL;
+	pos = pos ? strstr(pos, "Glyphs") : NULL;
+	long *gl = pos ? numbers(&pos, &ng) : NULL;
+	pos = pos ? strstr(pos, "GFXfont") : NULL;
+	long *ft = pos ? numbers(&pos, &nf) : NULL;
+	if (!bm || !gl || !ft || ng % 6 || nf < 3) {
+		fprintf(stderr, "fonte GFX não reconhecida\n");
+		exit(1);
+	}
+	long first = ft[nf - 3], last = ft[nf - 2], yadv = ft[nf - 1];
+	size_t glyphs = ng / 6;
+	if (last < first || (size_t)(last - first + 1) != glyphs) {
+		fprintf(stderr, "fonte GFX: %zu glifos para 0x%lX..0x%lX\n", glyphs, first, last);
+		exit(1);
+	}
+
+	*size = 4 + glyphs * 8 + nb;
+	uint8_t *d = calloc(1, *size), *g = d + 4;
+	d[0] = first;
+	d[1] = last;
+	d[2] = yadv;
+	for (size_t i = 0; i < glyphs; i++, g += 8) {
+		long *e = &gl[i * 6];
+		g[0] = e[0] & 0xFF;
+		g[1] = e[0] >> 8;
+		g[2] = e[1];
+		g[3] = e[2];
+		g[4] = e[3];
+		g[5] = (uint8_t)(int8_t)e[4];
+		g[6] = (uint8_t)(int8_t)e[5];
+	}
+	for (size_t i = 0; i < nb; i++)
+		g[i] = bm[i];
+	return d;
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+	put16(p, v);
+	put16(p + 2, v >> 16);
+}
+
+static int by_id(const void *a, const void *b)
+{
+	const entry_t *x = a, *y = b;
+	return (x->id > y->id) - (x->id < y->id);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 3) {
+		fprintf(stderr, "uso: %s saida.bin|saida.c nome=formato:arquivo[:w:h] ...\n", argv[0]);
+		return 1;
+	}
+	int n = argc - 2;
+	entry_t *e = calloc(n, sizeof(entry_t));
+
+	for (int i = 0; i < n; i++) {
+		char *spec = strdup(argv[i + 2]);
+		char *eq = strchr(spec, '='), *fmt, *file, *ws, *hs;
+		if (!eq) {
+			fprintf(stderr, "%s: esperado nome=formato:arquivo\n", argv[i + 2]);
+			return 1;
+		}
+		*eq = 0;
+		fmt = strtok(eq + 1, ":");
+		file = strtok(NULL, ":");
+		ws = strtok(NULL, ":");
+		hs = strtok(NULL, ":");
+		if (!fmt || !file || strlen(spec) > NAME_MAX_LEN || !*spec) {
+			fprintf(stderr, "%s: nome (até %d caracteres), formato e arquivo\n", argv[i + 2], NAME_MAX_LEN);
+			return 1;
+		}
+		strcpy(e[i].name, spec);
+		e[i].id = hash(spec);
+		e[i].data = load(file, &e[i].size);
+
+		if (!strcmp(fmt, "rgb565")) {
+			e[i].format = F_RGB565;
+			e[i].w = ws ? atoi(ws) : 0;
+			e[i].h = hs ? atoi(hs) : 0;
+			if (!e[i].w || !e[i].h || e[i].size != (uint32_t)e[i].w * e[i].h * 2) {
+				fprintf(stderr, "%s: rgb565 precisa de w:h coerentes com o arquivo\n", spec);
+				return 1;
+			}
+		} else if (!strcmp(fmt, "rle") || !strcmp(fmt, "qoi")) {
+			const uint8_t *d = e[i].data;
+			e[i].format = (fmt[0] == 'r') ? F_RLE : F_QOI;
+			if (e[i].size < 6 || (e[i].format == F_RLE ? (d[0] != 'R' || d[1] != 'L') : (d[0] != 'Q' || d[1] != '6'))) {
+				fprintf(stderr, "%s: arquivo não gerado por img_encode -b %s\n", spec, fmt);
+				return 1;
+			}
+			e[i].w = d[2] | (d[3] << 8);
+			e[i].h = d[4] | (d[5] << 8);
+		} else if (!strcmp(fmt, "jpeg")) {
+			e[i].format = F_JPEG;
+			if (jpeg_size(e[i].data, e[i].size, &e[i].w, &e[i].h)) {
+				fprintf(stderr, "%s: JPEG inválido\n", spec);
+				return 1;
+			}
+		} else if (!strcmp(fmt, "font")) {
+			e[i].format = F_FONT;
+			e[i].data = font_blob((char *)e[i].data, &e[i].size);
+		} else {
+			fprintf(stderr, "%s: formato desconhecido %s\n", spec, fmt);
+			return 1;
+		}
+		for (int j = 0; j < i; j++)
+			if (!strcmp(e[j].name, e[i].name)) {
+				fprintf(stderr, "%s: nome repetido\n", spec);
+				return 1;
+			}
+		free(spec);
+	}
+
+	qsort(e, n, sizeof(entry_t), by_id);
+	uint32_t off = PACK_HEADER + n * PACK_ENTRY;
+	for (int i = 0; i < n; i++) {
+		e[i].offset = off;
+		off = (off + e[i].size + 3) & ~3u;
+	}
+
+	uint8_t *pk = calloc(1, off);
+	put32(pk, PACK_MAGIC);
+	put16(pk + 4, PACK_VERSION);
+	put16(pk + 6, n);
+	put32(pk + 8, off);
+	for (int i = 0; i < n; i++) {
+		uint8_t *ix = pk + PACK_HEADER + i * PACK_ENTRY;
+		put32(ix, e[i].id);
+		put32(ix + 4, e[i].offset);
+		put32(ix + 8, e[i].size);
+		put16(ix + 12, e[i].format);
+		put16(ix + 14, e[i].w);
+		put16(ix + 16, e[i].h);
+		memcpy(ix + 20, e[i].name, strlen(e[i].name));
+		memcpy(pk + e[i].offset, e[i].data, e[i].size);
+		fprintf(stderr, "%-11s %08X fmt %u %ux%u %u bytes\n", e[i].name, e[i].id, e[i].format, e[i].w, e[i].h,
+				e[i].size);
+	}
+
+	const char *out = argv[1];
+	size_t len = strlen(out);
+	FILE *f = fopen(out, "wb");
+	if (!f) {
+		perror(out);
+		return 1;
+	}
+	if (len > 2 && !strcmp(out + len - 2, ".c")) {
+		fprintf(f, "/* Pacote de recursos gerado por asset_pack: %d itens, %u bytes */\n", n, off);
+		fprintf(f, "#include <stdint.h>\n\n");
+		fprintf(f, "__attribute__((section(\".assets\"), aligned(4), used))\nconst uint8_t asset_pack[%u] = {", off);
+		for (uint32_t i = 0; i < off; i++)
+			fprintf(f, "%s0x%02X,", (i % 16) ? " " : "\n\t", pk[i]);
+		fprintf(f, "\n};\n");
+	} else {
+		fwrite(pk, 1, off, f);
+	}
+	fclose(f);
+	fprintf(stderr, "%s: %d itens, %u bytes\n", out, n, off);
+	return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ ******************************************************************************
+ * @file    fontconvert_aa.c
+ * @brief   Gera fontes suavizadas (GFXfontAA, 4 bits por pixel) a partir de
+ * 			arquivos TrueType, para tft_writeAA()/tft_drawCharAA().
+ ******************************************************************************
+ * @attention
+ *
+ * Ferramenta de PC (não faz parte do firmware), usa a FreeType:
+ *   gcc -O2 -o fontconvert_aa fontconvert_aa.c $(pkg-config --cflags --libs freetype2)
+ *   fontconvert_aa fonte.ttf tamanho [primeiro] [último] > fonteAA.h
+ * Usa a mesma resolução (141 dpi) e as mesmas métricas do fontconvert da
+ * Adafruit, que gerou as fontes de fonts.c, então FreeMonoBold.ttf com
+ * tamanho 18 tem os mesmos avanços e deslocamentos de mono18x7bold. A
+ * cobertura de 8 bits da FreeType é arredondada para 4 bits; cada glifo
+ * começa em um byte, com os pixels das linhas em sequência (nibble alto
+ * primeiro).
+ ******************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_GLYPH_H
+
+#define DPI		141		//mesma resolução do fontconvert da Adafruit
+
+typedef struct {
+	uint16_t offset;
+	uint8_t w, h, adv;
+	int8_t xo, yo;
+} glyph_t;
+
+static uint8_t *bits;
+static size_t nbits, capbits;
+
+static void put(uint8_t b)
+{
+	if (nbits == capbits)
+		bits = realloc(bits, capbits = capbits ? capbits * 2 : 4096);
+	bits[nbits++] = b;
+}
+
+int main(int argc, char **argv)
+{
+	FT_Library lib;
+	FT_Face face;
+	int first = ' ', last = '~', size;
+
+	if (argc < 3) {
+		fprintf(stderr, "uso: %s fonte.ttf tamanho [primeiro] [último]\n", argv[0]);
+		return 1;
+	}
+	size = atoi(argv[2]);
+	if (argc > 3)
+		first = atoi(argv[3]);
+	if (argc > 4)
+		last = atoi(argv[4]);
+	if (size <= 0 || first < 0 || last > 255 || last < first) {
+		fprintf(stderr, "tamanho ou faixa de caracteres inválidos\n");
+		return 1;
+	}
+
+	/* nome: arquivo sem diretório e extensão + tamanho, como no fontconvert */
+	const char *file = strrchr(argv[1], '/') ? strrchr(argv[1], '/') + 1 : argv[1];
+	char name[128], *p;
+	snprintf(name, sizeof(name), "%s", file);
+	if ((p = strrchr(name, '.')))
+		*p = 0;
+	for (p = name; *p; p++)
+		if (!isalnum((unsigned char)*p))
+			*p = '_';
+	snprintf(name + strlen(name), sizeof(name) - strlen(name), "%dpt%dbAA", size, (last > 127) ? 8 : 7);
+
+	if (FT_Init_FreeType(&lib) || FT_New_Face(lib, argv[1], 0, &face)) {
+		fprintf(stderr, "%s: não foi possível abrir a fonte\n", argv[1]);
+		return 1;
+	}
+	FT_Set_Char_Size(face, size << 6, 0, DPI, 0);
+
+	int n = last - first + 1;
+	glyph_t *g = calloc(n, sizeof(glyph_t));
+
+	for (int c = first; c <= last; c++) {
+		glyph_t *e = &g[c - first];
+		if (FT_Load_Char(face, c, FT_LOAD_TARGET_NORMAL) || FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL)) {
+			fprintf(stderr, "caractere 0x%02X ignorado\n", c);
+			continue;
+		}
+		FT_Bitmap *b = &face->glyph->bitmap;
+		if (nbits > 0xFFFF) {
+			fprintf(stderr, "fonte grande demais para o offset de 16 bits\n");
+			return 1;
+		}
+		e->offset = nbits;
+		e->w = b->width;
+		e->h = b->rows;
+		e->adv = face->glyph->advance.x >> 6;
+		e->xo = face->glyph->bitmap_left;
+		e->yo = 1 - face->glyph->bitmap_top;
+
+		uint8_t acc = 0, odd = 0;
+		for (unsigned y = 0; y < b->rows; y++)
+			for (unsigned x = 0; x < b->width; x++) {
+				uint8_t v = (b->buffer[y * b->pitch + x] * 15 + 127) / 255;
+				if (odd)
+					put(acc | v);
+				else
+					acc = v << 4;
+				odd ^= 1;
+			}
+		if (odd)
+			put(acc);
+	}
+
+	printf("/* %s: gerada por fontconvert_aa a partir de %s, %d pt */\n\n", name, file, size);
+	printf("const uint8_t %sBitmaps[] = {", name);
+	for (size_t i = 0; i < nbits; i++)
+		printf("%s0x%02X,", (i % 12) ? " " : "\n  ", bits[i]);
+	printf("\n};\n\nconst GFXglyph %sGlyphs[] = {\n", name);
+	for (int i = 0; i < n; i++)
+		printf("  { %5u, %3u, %3u, %3u, %4d, %4d },   // 0x%02X\n", g[i].offset, g[i].w, g[i].h, g[i].adv, g[i].xo,
+				g[i].yo, first + i);
+	printf("};\n\nconst GFXfontAA %s = {\n  (uint8_t  *)%sBitmaps,\n  (GFXglyph *)%sGlyphs,\n  0x%02X, 0x%02X, %ld };\n", name,
+			name, name, first, last, face->size->metrics.height >> 6);
+
+	FT_Done_Face(face);
+	FT_Done_FreeType(lib);
+	return 0;
+}
@@ -0,0 +1,218 @@
+/**
+ ******************************************************************************
+ * @file    img_encode.c
+ * @brief   Gera imagens comprimidas para tft_image a partir de RGB565 cru.
+ ******************************************************************************
+ * @attention
+ *
+ * Ferramenta de PC (não faz parte do firmware):
+ *   gcc -O2 -o img_encode img_encode.c
+ *   img_encode [-b] rle|qoi nome w h imagem.raw > nome.c
+ * O arquivo tem w*h pixels RGB565 little-endian. O modo rle gera um vetor
+ * uint16_t para tft_drawRLE(); o modo qoi gera um vetor uint8_t para
+ * tft_drawQOI(). Com -b a saída é binária (little-endian), para o
+ * empacotador de recursos Tools/asset_pack.c.
+ ******************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define IMAGE_RLE	0x4C52
+#define IMAGE_RUN	0x8000
+#define RUN_MIN		3		//repetições menores viram literais
+
+#define QOI_OP_INDEX	0x00
+#define QOI_OP_DIFF		0x40
+#define QOI_OP_LUMA		0x80
+#define QOI_OP_RUN		0xC0
+#define QOI_OP_RGB		0xFE
+#define QOI_HASH(r, g, b)	(((r) * 3 + (g) * 5 + (b) * 7) & 63)
+
+static uint16_t *out;
+static size_t out_n, out_cap;
+static uint8_t *out8;
+static size_t out8_n, out8_cap;
+
+static void emit(uint16_t v)
+{
+	if (out_n == out_cap) {
+		out_cap = out_cap ? out_cap * 2 : 4096;
+		out = realloc(out, out_cap * sizeof(uint16_t));
+		if (!out) {
+			perror("realloc");
+			exit(1);
+		}
+	}
+	out[out_n++] = v;
+}
+
+static void emit8(uint8_t v)
+{
+	if (out8_n == out8_cap) {
+		out8_cap = out8_cap ? out8_cap * 2 : 8192;
+		out8 = realloc(out8, out8_cap);
+		if (!out8) {
+			perror("realloc");
+			exit(1);
+		}
+	}
+	out8[out8_n++] = v;
+}
+
+/* diferença com sinal entre dois campos de 'bits' bits, com estouro */
+static int wrap(int a, int b, int bits)
+{
+	int d = (a - b) & ((1 << bits) - 1);
+	return (d >= 1 << (bits - 1)) ? d - (1 << bits) : d;
+}
+
+static void encode_qoi(const uint16_t *px, int w, int h)
+{
+	uint16_t index[64] = { 0 }, prev = 0;
+	size_t n = (size_t)w * h;
+	int run = 0;
+
+	emit8('Q'); emit8('6');
+	emit8(w & 0xFF); emit8(w >> 8);
+	emit8(h & 0xFF); emit8(h >> 8);
+	for (size_t i = 0; i < n; i++) {
+		uint16_t c = px[i];
+		if (c == prev) {
+			if (++run == 62 || i == n - 1) {
+				emit8(QOI_OP_RUN | (run - 1));
+				run = 0;
+			}
+			continue;
+		}
+		if (run) {
+			emit8(QOI_OP_RUN | (run - 1));
+			run = 0;
+		}
+		int r = c >> 11, g = (c >> 5) & 63, b = c & 31;
+		int pr = prev >> 11, pg = (prev >> 5) & 63, pb = prev & 31;
+		int h6 = QOI_HASH(r, g, b);
+		prev = c;
+		if (index[h6] == c) {
+			emit8(QOI_OP_INDEX | h6);
+			continue;
+		}
+		index[h6] = c;
+		int dr = wrap(r, pr, 5), dg = wrap(g, pg, 6), db = wrap(b, pb, 5);
+		int dr_dg = dr - dg, db_dg = db - dg;
+		if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+			emit8(QOI_OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+		} else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+			emit8(QOI_OP_LUMA | (dg + 32));
+			emit8(((dr_dg + 8) << 4) | (db_dg + 8));
+		} else {
+			emit8(QOI_OP_RGB);
+			emit8(c & 0xFF);
+			emit8(c >> 8);
+		}
+	}
+}
+
+static void encode_rle(const uint16_t *px, int w, int h)
+{
+	size_t n = (size_t)w * h, i = 0;
+
+	emit(IMAGE_RLE); emit(w); emit(h);
+	while (i < n) {
+		size_t run = 1;
+		while (i + run < n && px[i + run] == px[i] && run < 0x8000)
+			run++;
+		if (run >= RUN_MIN) {
+			emit(IMAGE_RUN | (run - 1));
+			emit(px[i]);
+			i += run;
+			continue;
+		}
+		/* literais até o início da próxima repetição */
+		size_t lit = 0;
+		while (i + lit < n && lit < 0x8000) {
+			if (i + lit + RUN_MIN <= n && px[i + lit] == px[i + lit + 1] && px[i + lit] == px[i + lit + 2])
+				break;
+			lit++;
+		}
+		emit(lit - 1);
+		for (size_t k = 0; k < lit; k++)
+			emit(px[i + k]);
+		i += lit;
+	}
+}
+
+static uint16_t *load(const char *path, int w, int h)
+{
+	size_t n = (size_t)w * h;
+	uint16_t *img = malloc(n * sizeof(uint16_t));
+	uint8_t *raw = malloc(n * 2);
+	FILE *f = fopen(path, "rb");
+
+	if (!f || fread(raw, 2, n, f) != n) {
+		fprintf(stderr, "%s: esperado %dx%d pixels RGB565\n", path, w, h);
+		exit(1);
+	}
+	fclose(f);
+	for (size_t i = 0; i < n; i++)
+		img[i] = raw[2 * i] | (raw[2 * i + 1] << 8);
+	free(raw);
+	return img;
+}
+
+int main(int argc, char **argv)
+{
+	int binary = 0;
+
+	if (argc > 1 && !strcmp(argv[1], "-b")) {
+		binary = 1;
+		argc--;
+		argv++;
+	}
+	if (argc != 6) {
+		fprintf(stderr, "uso: %s [-b] rle|qoi nome w h imagem.raw\n", argv[0]);
+		return 1;
+	}
+	const char *mode = argv[1], *name = argv[2];
+	int w = atoi(argv[3]), h = atoi(argv[4]);
+	if (w <= 0 || h <= 0 || w > 0x7FFF || h > 0x7FFF) {
+		fprintf(stderr, "dimensões inválidas\n");
+		return 1;
+	}
+	uint16_t *px = load(argv[5], w, h);
+
+	if (!strcmp(mode, "rle")) {
+		encode_rle(px, w, h);
+	} else if (!strcmp(mode, "qoi")) {
+		encode_qoi(px, w, h);
+		if (binary) {
+			fwrite(out8, 1, out8_n, stdout);
+			return 0;
+		}
+		printf("/* %s: %dx%d %s; %zu bytes (%zu cru) */\n", name, w, h, mode, out8_n, (size_t)w * h * 2);
+		printf("#include <stdint.h>\n\nconst uint8_t %s[%zu] = {", name, out8_n);
+		for (size_t i = 0; i < out8_n; i++)
+			printf("%s0x%02X,", (i % 16) ? " " : "\n\t", out8[i]);
+		printf("\n};\n");
+		return 0;
+	} else {
+		fprintf(stderr, "modo desconhecido: %s\n", mode);
+		return 1;
+	}
+
+	if (binary) {
+		for (size_t i = 0; i < out_n; i++) {
+			putchar(out[i] & 0xFF);
+			putchar(out[i] >> 8);
+		}
+		return 0;
+	}
+	printf("/* %s: %dx%d %s; %zu bytes (%zu cru) */\n", name, w, h, mode, out_n * 2, (size_t)w * h * 2);
+	printf("#include <stdint.h>\n\nconst uint16_t %s[%zu] = {", name, out_n);
+	for (size_t i = 0; i < out_n; i++)
+		printf("%s0x%04X,", (i % 12) ? " " : "\n\t", out[i]);
+	printf("\n};\n");
+	return 0;
+}
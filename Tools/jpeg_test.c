@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ * @file    jpeg_test.c
+ * @brief   Compara a saída de tft_drawJPEG() com uma decodificação de referência.
+ ******************************************************************************
+ * @attention
+ *
+ * Ferramenta de PC (não faz parte do firmware). Decodifica o arquivo com
+ * tft_jpeg.c em uma tela de memória e compara com uma imagem PPM (P6) ou
+ * PGM (P5) do mesmo tamanho, por exemplo da djpeg da libjpeg, que usa a
+ * mesma ampliação do croma por repetição com -nosmooth:
+ *   gcc -O2 -I../Core/Inc -I../Drivers/STM32F4xx_HAL_Driver/Inc
+ *       -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include
+ *       -DSTM32F446xx -o jpeg_test jpeg_test.c ../Core/Src/tft_jpeg.c
+ *   djpeg -dct int -nosmooth -scale 1/2 foto.jpg > ref.ppm
+ *   jpeg_test foto.jpg ref.ppm 1 [tolerância]
+ * A escala é 0 (1), 1 (1/2), 2 (1/4) ou 3 (1/8). A referência é reduzida
+ * para RGB565 e a diferença é medida em níveis de 5/6 bits; a IDCT tem
+ * constantes de 12 bits (a da libjpeg, 13), então diferenças de 1 nível
+ * são esperadas. Retorna 1 se a maior diferença passa da tolerância
+ * (padrão 2).
+ ******************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "tft_jpeg.h"
+
+#define SCREEN_W	1024
+#define SCREEN_H	1024
+
+static uint16_t screen[SCREEN_W * SCREEN_H];
+static int16_t wx, wy, ww, wh;
+static int32_t wpos;
+
+/* Tela de memória no lugar do LCD ------------------------------------------*/
+int16_t tft_width(void)
+{
+	return SCREEN_W;
+}
+
+int16_t tft_height(void)
+{
+	return SCREEN_H;
+}
+
+const tft_target_t *tft_getTarget(void)
+{
+	return NULL;
+}
+
+void tft_startWrite(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+	wx = x;
+	wy = y;
+	ww = w;
+	wh = h;
+	wpos = 0;
+}
+
+void tft_writeColors(const uint16_t *block, uint32_t n)
+{
+	while (n--) {
+		int32_t x = wx + wpos % ww, y = wy + wpos / ww;
+		if (wpos++ < (int32_t)ww * wh)
+			screen[y * SCREEN_W + x] = *block++;
+	}
+}
+
+void tft_endWrite(void)
+{
+}
+
+/* Arquivos -----------------------------------------------------------------*/
+static uint8_t *load(const char *name, long *size)
+{
+	FILE *f = fopen(name, "rb");
+	uint8_t *d;
+
+	if (!f)
+		return NULL;
+	fseek(f, 0, SEEK_END);
+	*size = ftell(f);
+	rewind(f);
+	d = malloc(*size);
+	if (fread(d, 1, *size, f) != (size_t)*size) {
+		free(d);
+		d = NULL;
+	}
+	fclose(f);
+	return d;
+}
+
+static int pnm_int(const uint8_t **p, const uint8_t *end)
+{
+	int v = 0;
+
+	while (*p < end && (**p == ' ' || **p == '\n' || **p == '\r' || **p == '\t' || **p == '#')) {
+		if (**p == '#')
+			while (*p < end && **p != '\n')
+				(*p)++;
+		else
+			(*p)++;
+	}
+	while (*p < end && **p >= '0' && **p <= '9')
+		v = v * 10 + *(*p)++ - '0';
+	return v;
+}
+
+int main(int argc, char **argv)
+{
+	long jsize, rsize;
+	uint8_t *jpg, *ref;
+	uint16_t jw, jh;
+
+	if (argc < 4) {
+		fprintf(stderr, "uso: %s imagem.jpg referência.ppm escala [tolerância]\n", argv[0]);
+		return 2;
+	}
+	uint8_t scale = atoi(argv[3]);
+	int tol = (argc > 4) ? atoi(argv[4]) : 2;
+
+	if (!(jpg = load(argv[1], &jsize)) || !(ref = load(argv[2], &rsize))) {
+		fprintf(stderr, "não foi possível ler os arquivos\n");
+		return 2;
+	}
+
+	const uint8_t *p = ref + 2, *end = ref + rsize;
+	if (rsize < 2 || ref[0] != 'P' || (ref[1] != '5' && ref[1] != '6')) {
+		fprintf(stderr, "%s: esperado PPM (P6) ou PGM (P5)\n", argv[2]);
+		return 2;
+	}
+	int ch = (ref[1] == '6') ? 3 : 1;
+	int w = pnm_int(&p, end), h = pnm_int(&p, end), maxv = pnm_int(&p, end);
+	p++;
+	if (maxv != 255 || end - p < (long)w * h * ch) {
+		fprintf(stderr, "%s: só PNM de 8 bits\n", argv[2]);
+		return 2;
+	}
+
+	int8_t err = tft_jpegSize(jpg, jsize, &jw, &jh);
+	if (err) {
+		fprintf(stderr, "tft_jpegSize: erro %d\n", err);
+		return 1;
+	}
+	int sw = (jw + (1 << scale) - 1) >> scale, sh = (jh + (1 << scale) - 1) >> scale;
+	if (sw != w || sh != h || w > SCREEN_W || h > SCREEN_H) {
+		fprintf(stderr, "tamanhos diferentes: %dx%d decodificado, %dx%d na referência\n", sw, sh, w, h);
+		return 1;
+	}
+	memset(screen, 0, sizeof(screen));
+	if ((err = tft_drawJPEG(0, 0, jpg, jsize, scale)) != TFT_JPEG_OK) {
+		fprintf(stderr, "tft_drawJPEG: erro %d\n", err);
+		return 1;
+	}
+
+	int maxd = 0, hist[4] = { 0 };
+	for (int y = 0; y < h; y++)
+		for (int x = 0; x < w; x++) {
+			const uint8_t *q = p + ((long)y * w + x) * ch;
+			uint16_t c = screen[y * SCREEN_W + x];
+			int d[3] = {
+				abs((c >> 11) - (q[0] >> 3)),
+				abs(((c >> 5) & 0x3F) - (q[(ch == 3) ? 1 : 0] >> 2)),
+				abs((c & 0x1F) - (q[(ch == 3) ? 2 : 0] >> 3))
+			};
+			for (int k = 0; k < 3; k++) {
+				if (d[k] > maxd)
+					maxd = d[k];
+				hist[(d[k] > 3) ? 3 : d[k]]++;
+			}
+		}
+
+	long total = (long)w * h * 3;
+	printf("%s escala 1/%d, %dx%d: maior diferença %d, canais iguais %.2f%%, 1 nível %.2f%%, 2 %.2f%%, 3+ %.2f%%\n",
+			argv[1], 1 << scale, w, h, maxd, 100.0 * hist[0] / total, 100.0 * hist[1] / total,
+			100.0 * hist[2] / total, 100.0 * hist[3] / total);
+	free(jpg);
+	free(ref);
+	return maxd > tol;
+}
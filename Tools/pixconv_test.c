@@ -0,0 +1,241 @@
+/**
+ ******************************************************************************
+ * @file    pixconv_test.c
+ * @brief   Teste de resultados e medida de tempo das conversões de tft_pixconv.
+ ******************************************************************************
+ * @attention
+ *
+ * Ferramenta de PC (não faz parte do firmware). Compara cada conversão em
+ * bloco com uma referência de um pixel por vez, com dados aleatórios,
+ * tamanhos de 0 a 67 pixels, ponteiros desalinhados e conversão no próprio
+ * buffer, e depois mede o tempo das duas versões:
+ *   gcc -O2 -I../Core/Inc -I../Drivers/STM32F4xx_HAL_Driver/Inc
+ *       -I../Drivers/CMSIS/Device/ST/STM32F4xx/Include -I../Drivers/CMSIS/Include
+ *       -DSTM32F446xx -o pixconv_test pixconv_test.c ../Core/Src/tft_pixconv.c
+ *   pixconv_test [pixels por medida]
+ * No PC é testado o código C equivalente; o caminho SIMD do Cortex-M4 dá os
+ * mesmos resultados por construção (mesmas fórmulas, saturação no lugar do
+ * teste de limite).
+ ******************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "tft_pixconv.h"
+
+#define MAXN	67
+
+static int fails;
+
+/* Referências, um pixel por vez --------------------------------------------*/
+static uint8_t clamp(int32_t v)
+{
+	return (v < 0) ? 0 : (v > 255) ? 255 : v;
+}
+
+static void ref_rgb888_to_565(const uint8_t *in, uint16_t *out, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++, in += 3)
+		out[i] = ((in[0] >> 3) << 11) | ((in[1] >> 2) << 5) | (in[2] >> 3);
+}
+
+static void ref_565_to_666(const uint16_t *in, uint8_t *out, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++, out += 3) {
+		out[0] = (in[i] >> 11) << 3;
+		out[1] = ((in[i] >> 5) & 0x3F) << 2;
+		out[2] = (in[i] & 0x1F) << 3;
+	}
+}
+
+static void ref_565_to_555(const uint16_t *in, uint16_t *out, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		uint16_t c = in[i];
+		out[i] = (c & 0xFFC0) | ((c & 0x1F) << 1) | (c & 1);
+	}
+}
+
+static void ref_555_to_565(const uint16_t *in, uint16_t *out, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		uint16_t c = in[i];
+		out[i] = (c & 0xFFC0) | ((c & 0x0400) >> 5) | ((c >> 1) & 0x1F);
+	}
+}
+
+static void ref_swapRB565(const uint16_t *in, uint16_t *out, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		uint16_t c = in[i];
+		out[i] = (c & 0x07E0) | (c >> 11) | ((c & 0x1F) << 11);
+	}
+}
+
+static void ref_swapBytes16(const uint16_t *in, uint16_t *out, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++)
+		out[i] = (uint16_t)((in[i] >> 8) | (in[i] << 8));
+}
+
+static void ref_yuv422_to_565(const uint8_t *in, uint16_t *out, uint32_t n)
+{
+	for (uint32_t i = 0; i < (n & ~1u); i++) {
+		const uint8_t *q = in + (i & ~1u) * 2;
+		int32_t y = q[(i & 1) * 2], u = q[1] - 128, v = q[3] - 128;
+		uint8_t r = clamp(y + ((359 * v) >> 8));
+		uint8_t g = clamp(y - ((88 * u + 183 * v) >> 8));
+		uint8_t b = clamp(y + ((454 * u) >> 8));
+		out[i] = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+	}
+}
+
+/* Comparação ---------------------------------------------------------------*/
+typedef void (*conv16_t)(const uint16_t *, uint16_t *, uint32_t);
+
+static void fill(void *p, size_t bytes)
+{
+	for (size_t i = 0; i < bytes; i++)
+		((uint8_t *)p)[i] = rand();
+}
+
+static void check(const char *name, uint32_t n, int off, int inplace, const void *a, const void *b, size_t bytes)
+{
+	if (memcmp(a, b, bytes)) {
+		printf("FALHA %s: n=%u desalinhado=%d no próprio buffer=%d\n", name, n, off, inplace);
+		fails++;
+	}
+}
+
+static void test16(const char *name, conv16_t fn, conv16_t ref)
+{
+	uint16_t in[MAXN + 1], out[MAXN + 1], exp[MAXN + 1];
+
+	for (uint32_t n = 0; n <= MAXN; n++)
+		for (int off = 0; off < 2; off++) {
+			fill(in, sizeof(in));
+			ref(in + off, exp, n);
+			fn(in + off, out, n);
+			check(name, n, off, 0, out, exp, n * 2);
+			fn(in + off, in + off, n);
+			check(name, n, off, 1, in + off, exp, n * 2);
+		}
+}
+
+static void test888(void)
+{
+	uint8_t in[3 * MAXN + 3];
+	uint16_t out[MAXN + 1], exp[MAXN];
+
+	for (uint32_t n = 0; n <= MAXN; n++)
+		for (int off = 0; off < 4; off++) {
+			fill(in, sizeof(in));
+			ref_rgb888_to_565(in + off, exp, n);
+			tft_rgb888_to_565(in + off, out + (off & 1), n);
+			check("rgb888_to_565", n, off, 0, out + (off & 1), exp, n * 2);
+		}
+}
+
+static void test666(void)
+{
+	uint16_t in[MAXN + 1];
+	uint8_t out[3 * MAXN + 3], exp[3 * MAXN];
+
+	for (uint32_t n = 0; n <= MAXN; n++)
+		for (int off = 0; off < 4; off++) {
+			fill(in, sizeof(in));
+			ref_565_to_666(in + (off & 1), exp, n);
+			tft_565_to_666(in + (off & 1), out + off, n);
+			check("565_to_666", n, off, 0, out + off, exp, n * 3);
+		}
+}
+
+static void testYuv(void)
+{
+	uint8_t in[2 * MAXN + 2];
+	uint16_t out[MAXN + 1], exp[MAXN];
+
+	for (uint32_t n = 0; n <= MAXN; n += 2)
+		for (int off = 0; off < 2; off++) {
+			fill(in, sizeof(in));
+			ref_yuv422_to_565(in + off, exp, n);
+			tft_yuv422_to_565(in + off, out, n);
+			check("yuv422_to_565", n, off, 0, out, exp, n * 2);
+		}
+	/* extremos de Y, U e V, onde a saturação atua */
+	static const uint8_t ext[] = { 0, 1, 16, 128, 235, 254, 255 };
+	for (unsigned y = 0; y < sizeof(ext); y++)
+		for (unsigned u = 0; u < sizeof(ext); u++)
+			for (unsigned v = 0; v < sizeof(ext); v++) {
+				uint8_t q[4] = { ext[y], ext[u], ext[sizeof(ext) - 1 - y], ext[v] };
+				ref_yuv422_to_565(q, exp, 2);
+				tft_yuv422_to_565(q, out, 2);
+				check("yuv422_to_565 extremos", 2, 0, 0, out, exp, 4);
+			}
+}
+
+/* Tempo --------------------------------------------------------------------*/
+static double now(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+#define BENCH(name, call, refcall) \
+	do { \
+		double t0 = now(); \
+		for (int r = 0; r < reps; r++) call; \
+		double t1 = now(); \
+		for (int r = 0; r < reps; r++) refcall; \
+		double t2 = now(); \
+		printf("%-16s %8.2f %8.2f   %5.2fx\n", name, (t1 - t0) * 1e9 / ((double)reps * n), \
+				(t2 - t1) * 1e9 / ((double)reps * n), (t2 - t1) / (t1 - t0)); \
+	} while (0)
+
+int main(int argc, char **argv)
+{
+	uint32_t n = (argc > 1) ? strtoul(argv[1], NULL, 0) & ~1u : 320;
+	int reps;
+
+	if (n == 0)
+		n = 2;
+	reps = 20000000 / n + 1;
+
+	srand(1);
+	test888();
+	test666();
+	test16("565_to_555", tft_565_to_555, ref_565_to_555);
+	test16("555_to_565", tft_555_to_565, ref_555_to_565);
+	test16("swapRB565", tft_swapRB565, ref_swapRB565);
+	test16("swapBytes16", tft_swapBytes16, ref_swapBytes16);
+	testYuv();
+	if (fails) {
+		printf("%d falhas\n", fails);
+		return 1;
+	}
+	printf("resultados iguais à referência\n\n");
+
+	uint8_t *b8 = malloc(3 * n);
+	uint16_t *a16 = malloc(2 * n), *b16 = malloc(2 * n);
+	fill(b8, 3 * n);
+	fill(a16, 2 * n);
+
+	printf("%u pixels, ns por pixel:\n", n);
+	printf("%-16s %8s %8s   %s\n", "", "bloco", "1 a 1", "ganho");
+	BENCH("rgb888_to_565", tft_rgb888_to_565(b8, b16, n), ref_rgb888_to_565(b8, b16, n));
+	BENCH("565_to_666", tft_565_to_666(a16, b8, n), ref_565_to_666(a16, b8, n));
+	BENCH("565_to_555", tft_565_to_555(a16, b16, n), ref_565_to_555(a16, b16, n));
+	BENCH("555_to_565", tft_555_to_565(a16, b16, n), ref_555_to_565(a16, b16, n));
+	BENCH("swapRB565", tft_swapRB565(a16, b16, n), ref_swapRB565(a16, b16, n));
+	BENCH("swapBytes16", tft_swapBytes16(a16, b16, n), ref_swapBytes16(a16, b16, n));
+	BENCH("yuv422_to_565", tft_yuv422_to_565(b8, b16, n), ref_yuv422_to_565(b8, b16, n));
+
+	free(b8);
+	free(a16);
+	free(b16);
+	return 0;
+}